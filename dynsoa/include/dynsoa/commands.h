@@ -0,0 +1,24 @@
+// DynSoA Runtime SDK
+
+#pragma once
+#include "types.h"
+#include <cstddef>
+
+namespace dynsoa {
+
+// Deferred structural changes. Kernels (including parallel range kernels)
+// record into a per-thread command buffer; commands_flush(), run by
+// dynsoa_end_frame, applies them once no kernel holds column pointers.
+// Destroys are batched per view and applied first, then component changes
+// (batched per view and component), then spawns, so spawns reuse the freed
+// slots. A component change moves the entity to another view and retires its
+// handle, so further changes recorded for that handle in the same frame are
+// dropped like any stale handle.
+void cmd_spawn(ArchetypeId arch, std::size_t count, void(*init_fn)(std::size_t, void*) = nullptr);
+void cmd_destroy(ViewId v, EntityId e);
+void cmd_add_component(ViewId v, EntityId e, const char* component);
+void cmd_remove_component(ViewId v, EntityId e, const char* component);
+
+void commands_flush();
+
+} // namespace dynsoa
@@ -10,6 +10,13 @@
 #include "metrics.h"
 #include "scheduler.h"
 #include "kernels.h"
+#include "thread_pool.h"
+#include "perf_counters.h"
+#include "memory.h"
+#include "spatial.h"
+#include "commands.h"
+#include "query.h"
+#include "simd.h"
 
 extern "C" {
 
@@ -20,24 +27,99 @@ DYNSOA_API void dynsoa_define_component(const dynsoa::Component* c);
 DYNSOA_API dynsoa::ArchetypeId dynsoa_define_archetype(const char* name, const char** comps, int count);
 
 DYNSOA_API void*  dynsoa_spawn(dynsoa::ArchetypeId arch, size_t count, void(*init_fn)(size_t, void*));
+// In-place initialization through column pointers, parallel for large counts; returns the first row
+DYNSOA_API size_t dynsoa_spawn_bulk(dynsoa::ArchetypeId arch, size_t count, dynsoa::SpawnInitFn init_fn, void* user);
 DYNSOA_API dynsoa::ViewId dynsoa_make_view(dynsoa::ArchetypeId arch);
 DYNSOA_API size_t dynsoa_view_len(dynsoa::ViewId v);
 DYNSOA_API void*  dynsoa_column(dynsoa::ViewId v, const char* path);
+DYNSOA_API dynsoa::ColumnId dynsoa_column_id(dynsoa::ViewId v, const char* path);
+DYNSOA_API void*  dynsoa_column_ptr(dynsoa::ViewId v, dynsoa::ColumnId c);
+DYNSOA_API size_t dynsoa_view_tile_rows(dynsoa::ViewId v);
+DYNSOA_API void*  dynsoa_column_tile(dynsoa::ViewId v, dynsoa::ColumnId c, size_t tile);
+DYNSOA_API size_t dynsoa_view_capacity(dynsoa::ViewId v);
+DYNSOA_API size_t dynsoa_view_padded_len(dynsoa::ViewId v); // rows safe to process without a tail
+
+// Double-buffered columns: read c, write the returned back column; dynsoa_end_frame swaps them
+DYNSOA_API dynsoa::ColumnId dynsoa_set_double_buffered(dynsoa::ViewId v, dynsoa::ColumnId c);
+DYNSOA_API dynsoa::ColumnId dynsoa_column_next(dynsoa::ViewId v, dynsoa::ColumnId c);
+
+// NUMA placement (see memory.h); the policy itself comes from Config
+DYNSOA_API int dynsoa_numa_node_count();
+DYNSOA_API int dynsoa_view_row_node(dynsoa::ViewId v, size_t row); // -1 unless chunks are striped across nodes
+
+// Change tracking (see entity_store.h): stamps per change block, compared against a saved clock
+DYNSOA_API uint64_t dynsoa_change_clock();
+DYNSOA_API size_t   dynsoa_change_block_rows(dynsoa::ViewId v);
+DYNSOA_API void     dynsoa_mark_changed(dynsoa::ViewId v, dynsoa::ColumnId c, size_t row_begin, size_t row_end);
+DYNSOA_API uint64_t dynsoa_column_version(dynsoa::ViewId v, dynsoa::ColumnId c);
+DYNSOA_API size_t   dynsoa_changed_blocks(dynsoa::ViewId v, const dynsoa::ColumnId* cols, int k, uint64_t since,
+                                          uint32_t* out, size_t max_out); // returns changed block count
+
+// Entity handles
+DYNSOA_API dynsoa::EntityId dynsoa_entity_at(dynsoa::ViewId v, size_t row);
+DYNSOA_API size_t dynsoa_entity_row(dynsoa::ViewId v, dynsoa::EntityId e); // (size_t)-1 if stale
+DYNSOA_API int    dynsoa_destroy_entity(dynsoa::ViewId v, dynsoa::EntityId e);
+DYNSOA_API size_t dynsoa_destroy_entities(dynsoa::ViewId v, const dynsoa::EntityId* es, size_t n);
+// Move entities to the archetype with one component added/removed; out (optional,
+// n entries) receives the new handles. Returns entities moved.
+DYNSOA_API size_t dynsoa_add_component(dynsoa::ViewId v, const dynsoa::EntityId* es, size_t n,
+                                       const char* component, dynsoa::EntityId* out);
+DYNSOA_API size_t dynsoa_remove_component(dynsoa::ViewId v, const dynsoa::EntityId* es, size_t n,
+                                          const char* component, dynsoa::EntityId* out);
+
+// Deferred structural changes, safe to record from kernels; applied by dynsoa_end_frame
+DYNSOA_API void dynsoa_cmd_spawn(dynsoa::ArchetypeId arch, size_t count, void(*init_fn)(size_t, void*));
+DYNSOA_API void dynsoa_cmd_destroy(dynsoa::ViewId v, dynsoa::EntityId e);
+DYNSOA_API void dynsoa_cmd_add_component(dynsoa::ViewId v, dynsoa::EntityId e, const char* component);
+DYNSOA_API void dynsoa_cmd_remove_component(dynsoa::ViewId v, dynsoa::EntityId e, const char* component);
 
 // Retile helpers
 DYNSOA_API int  dynsoa_retile_aosoa_plan_apply(dynsoa::ViewId v, int tile);
 DYNSOA_API int  dynsoa_retile_to_soa(dynsoa::ViewId v);
+DYNSOA_API int  dynsoa_retile_sort_morton(dynsoa::ViewId v);
+// Stably group rows by (path & mask), mask 0 = all bits; groups are read back in key order
+DYNSOA_API int  dynsoa_partition_by_mask(dynsoa::ViewId v, const char* path, uint32_t mask);
+DYNSOA_API int  dynsoa_view_partitions(dynsoa::ViewId v, dynsoa::RowPartition* out, int max_out); // returns group count
+// Switch to fixed-size chunk storage (0 = 16 KiB); returns rows per chunk
+DYNSOA_API size_t dynsoa_set_chunked(dynsoa::ViewId v, size_t chunk_bytes);
 
 // Matrix blocks
 DYNSOA_API void* dynsoa_acquire_matrix_block(dynsoa::ViewId v, const char** comps, int k, int rows, size_t offset, dynsoa::MatrixBlock* out);
+DYNSOA_API void* dynsoa_acquire_matrix_block_ex(dynsoa::ViewId v, const char** comps, int k, int rows, size_t offset,
+                                                unsigned flags, dynsoa::MatrixBlock* out);
 DYNSOA_API void  dynsoa_release_matrix_block(dynsoa::ViewId v, dynsoa::MatrixBlock* mb, int write_back);
 
+// Spatial hash grid (opaque handle; see spatial.h)
+DYNSOA_API void* dynsoa_grid_create();
+DYNSOA_API void  dynsoa_grid_destroy(void* grid);
+DYNSOA_API void  dynsoa_grid_build(void* grid, dynsoa::ViewId v, dynsoa::ColumnId x, dynsoa::ColumnId y,
+                                   dynsoa::ColumnId z, float cell_size);
+DYNSOA_API int   dynsoa_grid_query(const void* grid, float x, float y, float z, float radius,
+                                   dynsoa::GridRange* out, int max_out);
+DYNSOA_API const uint32_t* dynsoa_grid_order(const void* grid); // slot -> row, length = view_len at build
+
+// Queries: every archetype containing a component set (see query.h)
+DYNSOA_API dynsoa::QueryId dynsoa_make_query(const char** comps, int k);
+DYNSOA_API int dynsoa_query_views(dynsoa::QueryId q, dynsoa::ViewId* out, int max_out); // returns match count
+
 // Scheduler/frames
 DYNSOA_API void dynsoa_begin_frame();
 DYNSOA_API void dynsoa_run_kernel(const char* name,
                                   void (*fn)(dynsoa::ViewId, const dynsoa::KernelCtx&),
                                   dynsoa::ViewId v,
                                   const dynsoa::KernelCtx* ctx);
+DYNSOA_API void dynsoa_run_kernel_parallel(const char* name,
+                                           void (*fn)(dynsoa::ViewId, const dynsoa::KernelCtx&, size_t, size_t),
+                                           dynsoa::ViewId v,
+                                           const dynsoa::KernelCtx* ctx);
+DYNSOA_API void dynsoa_run_kernel_query(const char* name,
+                                        void (*fn)(dynsoa::ViewId, const dynsoa::KernelCtx&, size_t, size_t),
+                                        dynsoa::QueryId q,
+                                        const dynsoa::KernelCtx* ctx);
+DYNSOA_API void dynsoa_run_kernel_changed(const char* name,
+                                          void (*fn)(dynsoa::ViewId, const dynsoa::KernelCtx&, size_t, size_t),
+                                          dynsoa::ViewId v, const dynsoa::ColumnId* cols, int k, uint64_t since,
+                                          const dynsoa::KernelCtx* ctx);
 DYNSOA_API void dynsoa_end_frame();
 DYNSOA_API void dynsoa_set_policy(const char* json_or_empty);
 
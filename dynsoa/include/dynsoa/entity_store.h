@@ -3,27 +3,238 @@
 #pragma once
 #include "types.h"
 #include <cstddef>
+#include <vector>
 
 namespace dynsoa {
 
 // Forward declaration to avoid circular include with layout.h
 enum class LayoutKind : std::uint8_t;
 
+// init_fn(row, packed) fills a scratch row with the fields in archetype order
+// (each at its natural size, no padding); it is scattered into the columns
+// before the next call. Prefer spawn_bulk for large counts.
 void*  spawn(ArchetypeId arch, std::size_t count, void(*init_fn)(std::size_t, void*));
+
+// Lane pointers of every column of a view for rows [first_row, first_row +
+// count), which never straddle a tile: get<T>(c)[i] is row first_row + i of
+// column c. Rows arrive zeroed.
+struct ColumnSet {
+  ViewId       view;
+  std::size_t  first_row;
+  std::size_t  count;
+  std::size_t  column_count;
+  void* const* columns; // indexed by ColumnId
+
+  template <class T>
+  T* get(ColumnId c) const {
+    return c >= 0 && (std::size_t)c < column_count ? static_cast<T*>(columns[c]) : nullptr;
+  }
+};
+
+using SpawnInitFn = void (*)(std::size_t first_row, std::size_t count, const ColumnSet* cols, void* user);
+
+// Append `count` entities and initialize them in place, one call per
+// tile-bounded run of at most kSpawnBatchRows rows; each run is zeroed right
+// before its call, so the whole spawn is a single write pass. Counts of
+// kParallelSpawnRows and up run on the thread pool, so init_fn must only
+// touch its own rows. Returns the first new row.
+constexpr std::size_t kSpawnBatchRows    = 4096;
+constexpr std::size_t kParallelSpawnRows = 32768;
+std::size_t spawn_bulk(ArchetypeId arch, std::size_t count, SpawnInitFn init_fn, void* user = nullptr);
+
 ViewId make_view(ArchetypeId arch);
 size_t view_len(ViewId v);
 
+// Storage is tiled: rows [k*T, (k+1)*T) of a column are contiguous lanes in
+// tile k, where T = view_tile_rows(v). In SoA the whole view is tile 0, so the
+// pointer returned by column()/column_ptr() covers every row; in AoSoA it only
+// covers the first T rows and kernels should walk tiles with column_tile().
 void*  column(ViewId v, const char* path);
 
-// Transient column-major block of selected components
+// Resolve-once column handles: column_id() hashes the path, column_ptr() is a flat array load.
+ColumnId column_id(ViewId v, const char* path);
+void*    column_ptr(ViewId v, ColumnId c);
+bool     column_has_type(ViewId v, ColumnId c, ScalarType t); // false for an invalid column
+
+std::size_t view_tile_rows(ViewId v);
+void*       column_tile(ViewId v, ColumnId c, std::size_t tile);
+
+// Every column_tile() pointer (lane 0 of a tile) is aligned to kColumnAlign,
+// and lane blocks are padded so reading or writing up to view_padded_len()
+// rows stays inside the view: kernels can run whole SIMD vectors (SoA) or
+// whole tiles (AoSoA, chunked) with no scalar tail. Padding rows read as zero
+// after any structural change; writes to them are discarded.
+constexpr std::size_t kColumnAlign = 64;
+constexpr std::size_t kPadRows     = kColumnAlign / sizeof(float); // one AVX-512 vector of F32
+
+std::size_t view_capacity(ViewId v);   // allocated rows
+std::size_t view_padded_len(ViewId v); // view_len rounded up to kPadRows (SoA) or a whole tile
+
+// Base alignment for view storage allocated from now on, rounded up to a
+// power of two >= kColumnAlign (e.g. 2 MiB to back columns with huge pages).
+// Set through Config::column_align by dynsoa_init.
+void set_column_alignment(std::size_t bytes);
+
+// NUMA node holding `row` of a chunked view whose chunks are striped across
+// nodes (NumaPolicy::Interleave, see memory.h); -1 when rows have no home node.
+int view_row_node(ViewId v, std::size_t row);
+
+// Change tracking. Rows are grouped into change blocks: the view's tiles when
+// tiled (AoSoA, chunked), else kChangeBlockRows-row blocks. Every block of
+// every column carries the stamp of its last write, drawn from one
+// process-wide clock. Stamps are set by structural changes (spawn, destroy,
+// migration, reorders and retiles, which all move rows), by matrix block
+// write-back, by the column_* helpers in simd.h and by TypedView for
+// non-const components; code writing through raw column pointers calls
+// mark_changed itself. A consumer keeps the change_clock() value from before
+// its last pass and revisits only the blocks stamped after it, so its cost
+// follows the changed blocks rather than the view length.
+constexpr std::size_t kChangeBlockRows = 4096;
+
+std::uint64_t change_clock();
+std::size_t   change_block_rows(ViewId v);
+// Safe from concurrent kernel tasks, as long as the view is not restructured:
+// it only stores stamps into blocks sized when the view last changed shape.
+void          mark_changed(ViewId v, ColumnId c, std::size_t begin, std::size_t end);
+std::uint64_t column_version(ViewId v, ColumnId c); // newest block stamp, 0 if never written
+// Blocks in which any of cols[0..k) changed after `since`, ascending. Fills
+// up to max_out entries of out and returns the full count.
+std::size_t   changed_blocks(ViewId v, const ColumnId* cols, int k, std::uint64_t since,
+                             std::uint32_t* out, std::size_t max_out);
+
+// Double-buffered (ping-pong) columns. set_double_buffered gives column c a
+// back buffer and returns its ColumnId (path + kNextSuffix): kernels read
+// frame N through c and write frame N+1 through the back column, so no row
+// reads another row's new value and neighbour kernels can run in parallel
+// with deterministic results. swap_column_buffers, called by
+// dynsoa_end_frame before deferred commands are applied, flips each pair
+// whose back buffer was written this frame: ColumnIds stay put, their tile
+// offsets swap. Re-fetch column pointers after a swap. Writes count through
+// their change marks (the column_* helpers, TypedView, matrix write-back or
+// mark_changed), tracked per row; the only rows copied at a swap are those
+// the back buffer lags on and the frame did not rewrite, so a kernel may
+// update only some rows, or skip a frame, without rolling the rest back.
+// Unmarked writes through raw column pointers are lost; debug builds warn.
+// Restructure views between frames (cmd_*): rows moved or spawned mid-frame
+// drop their back-buffer writes. Migrated rows keep their pairing. Returns
+// kInvalidColumn for a back column, or for a chunked view whose chunks
+// cannot hold the wider rows.
+constexpr const char* kNextSuffix = "@next";
+
+ColumnId set_double_buffered(ViewId v, ColumnId c);
+ColumnId column_next(ViewId v, ColumnId c); // back column of c, or kInvalidColumn
+void     swap_column_buffers();
+
+// Random row access over a tiled column; tile bases are resolved once.
+// Single-tile (SoA) views index the tile directly and power-of-two tilings
+// (AoSoA) split the row with a shift, so only odd chunk sizes pay a divide.
+template <class T>
+struct ColumnRows {
+  std::vector<T*> tiles;
+  std::size_t     tile_rows = 0;
+  T*              flat = nullptr; // tiles[0] when it is the only tile
+  unsigned        tile_shift = 0; // log2(tile_rows) for power-of-two tiles > 1
+  T& operator[](std::size_t row) const {
+    if (flat) return flat[row];
+    if (tile_shift) return tiles[row >> tile_shift][row & (tile_rows - 1)];
+    return tiles[row / tile_rows][row % tile_rows];
+  }
+  explicit operator bool() const { return !tiles.empty() && tiles[0]; }
+};
+
+template <class T>
+ColumnRows<T> column_rows(ViewId v, ColumnId c) {
+  ColumnRows<T> r;
+  r.tile_rows = view_tile_rows(v);
+  if (r.tile_rows == 0) return r;
+  const std::size_t n = (view_len(v) + r.tile_rows - 1) / r.tile_rows;
+  r.tiles.resize(n ? n : 1);
+  for (std::size_t k = 0; k < r.tiles.size(); ++k) r.tiles[k] = (T*)column_tile(v, c, k);
+  if (r.tiles.size() == 1) r.flat = r.tiles[0];
+  else if ((r.tile_rows & (r.tile_rows - 1)) == 0)
+    while ((std::size_t(1) << r.tile_shift) < r.tile_rows) ++r.tile_shift;
+  return r;
+}
+
+// Transient column-major block of selected components. Buffers come from a
+// per-thread pool of 64-byte aligned blocks keyed by (rows, cols). With
+// kMatrixBlockZeroCopy the block aliases the view's columns when the layout
+// allows it (writes land immediately; write_back then only marks them changed) and sets
+// kMatrixBlockZeroCopy in MatrixBlock::flags. Anything that moves storage
+// (growth, retiles) while a zero-copy block is out leaves its data stale.
 struct MatrixBlock;
-MatrixBlock acquire_matrix_block(ViewId v, const char** comps, int k, int block_rows, std::size_t offset_rows=0);
+MatrixBlock acquire_matrix_block(ViewId v, const char** comps, int k, int block_rows, std::size_t offset_rows=0,
+                                 unsigned flags=0);
 void        release_matrix_block(ViewId v, MatrixBlock* mb, bool write_back);
 
 // Extra helpers to avoid exposing internal ViewRec to other translation units
 std::size_t bytes_to_move(ViewId v);
 LayoutKind  entity_current_layout(ViewId v);
-void        transform_soa_to_aosoa(ViewId v, int tile);
-void        transform_aosoa_to_soa(ViewId v);
+// Both return false, leaving the view as it was, on chunked views.
+bool        transform_soa_to_aosoa(ViewId v, int tile);
+bool        transform_aosoa_to_soa(ViewId v);
+
+// Opt a view into chunked storage: every tile is a separate chunk_bytes
+// allocation holding all columns for as many rows as fit, so growth appends
+// chunks and never copies existing rows. Returns rows per chunk (0 if a
+// single row does not fit). Chunks are the view's tiles for column_tile(),
+// parallel dispatch and tile metrics.
+constexpr std::size_t kDefaultChunkBytes = 16 * 1024;
+std::size_t transform_to_chunked(ViewId v, std::size_t chunk_bytes = kDefaultChunkBytes);
+
+// Reorder every column of the view by the Morton (Z-order) key of the first
+// up-to-three F32/F64 fields of `component`, quantised over the view's bounds.
+// The tiling is unchanged. Returns false if the component has no such field.
+bool        transform_sort_morton(ViewId v, const char* component);
+// True while the view is still in the order of its last Morton sort on
+// `component`: no rows added, removed or reordered, and no key column block
+// stamped as changed since.
+bool        view_morton_sorted(ViewId v, const char* component);
+int         morton_key_dims(ViewId v, const char* component);
+
+// Stable grouping of rows by (key & mask) of the U32 column `path` (mask 0 =
+// every bit), so a kernel can run one branch-free loop per group instead of
+// switching per row. Rows keep their relative order within a group; a view
+// that is already grouped is left untouched. The tiling is unchanged.
+// view_partitions copies up to max_out groups in key order and returns the
+// group count; it is 0 until the next partition once rows are added,
+// removed or reordered.
+struct RowPartition {
+  std::uint32_t key; // flags & mask shared by every row of the group
+  std::uint32_t begin;
+  std::uint32_t end;
+};
+bool        transform_partition_by_mask(ViewId v, const char* path, std::uint32_t mask);
+bool        partition_key_valid(ViewId v, const char* path); // names a U32 column
+int         view_partitions(ViewId v, RowPartition* out, int max_out);
+bool        view_partitioned_by(ViewId v, const char* path, std::uint32_t mask); // groups still valid for key and mask
+
+// Generational entity handles, valid across retiles, reorders and other
+// entities' destruction. Every spawned row gets one (row_entity); a handle
+// goes stale once its entity is destroyed, even after the slot is reused.
+// entity_row returns (size_t)-1 and row_entity kInvalidEntity when not found.
+std::size_t entity_row(ViewId v, EntityId e);
+EntityId    row_entity(ViewId v, std::size_t row);
+bool        entity_alive(ViewId v, EntityId e);
+// Immediate removal; not safe while a kernel is iterating the view (record
+// cmd_destroy instead). A few removals swap the view's last rows into the
+// holes; larger batches compact the columns in order, one pass per column.
+bool        destroy_entity(ViewId v, EntityId e);
+std::size_t destroy_entities(ViewId v, const EntityId* es, std::size_t n); // returns rows removed
+
+// Move live entities of view v into archetype `to`'s view as one batch.
+// Columns both archetypes share are copied with memcpy in row runs; columns
+// only the target has start zeroed. The source handles go stale: out[i], if
+// given, receives entity i's handle in the target view (kInvalidEntity when
+// es[i] was not live). Same immediate-mode caveat as destroy_entities.
+// Returns the number of entities moved.
+std::size_t migrate_entities(ViewId v, const EntityId* es, std::size_t n, ArchetypeId to,
+                             EntityId* out = nullptr);
+// migrate_entities along the archetype graph edge that adds/removes one
+// component (see archetype_with / archetype_without).
+std::size_t add_component(ViewId v, const EntityId* es, std::size_t n, const char* component,
+                          EntityId* out = nullptr);
+std::size_t remove_component(ViewId v, const EntityId* es, std::size_t n, const char* component,
+                             EntityId* out = nullptr);
 
 } // namespace dynsoa
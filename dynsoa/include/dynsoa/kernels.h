@@ -6,9 +6,23 @@
 namespace dynsoa {
 
 using KernelFn = void (*)(ViewId, const KernelCtx&);
+// Processes rows [row_begin, row_end) of the view; ranges never split an AoSoA tile.
+using RangeKernelFn = void (*)(ViewId, const KernelCtx&, std::size_t row_begin, std::size_t row_end);
 
 void begin_frame();
 void run_kernel(const char* name, KernelFn fn, ViewId v, const KernelCtx& ctx);
+// Splits the view into tile-aligned row ranges and runs them on the worker
+// pool, calling fn once per tile so p95/p99_tile_us are per-tile latencies.
+void run_kernel_parallel(const char* name, RangeKernelFn fn, ViewId v, const KernelCtx& ctx);
+// One pool dispatch over the tile-aligned ranges of every view the query
+// matches; fn receives each range's own view. Emits one Sample per non-empty
+// view, whose time_us is the summed time of that view's ranges.
+void run_kernel_query(const char* name, RangeKernelFn fn, QueryId q, const KernelCtx& ctx);
+// Incremental form of run_kernel_parallel: runs fn only over the change
+// blocks (see entity_store.h) in which any of cols[0..k) changed after
+// `since`. Emits no Sample when nothing changed.
+void run_kernel_changed(const char* name, RangeKernelFn fn, ViewId v, const ColumnId* cols, int k,
+                        std::uint64_t since, const KernelCtx& ctx);
 void end_frame();
 
 } // namespace dynsoa
@@ -5,7 +5,11 @@
 
 namespace dynsoa {
 
-enum class LayoutKind : std::uint8_t { AoS=0, SoA=1, AoSoA=2, Matrix=3 };
+// MortonSorted and Partitioned are plan targets only: they reorder rows and
+// leave the view's tiling (and so current_layout) as it was.
+// Chunked keeps each tile in its own fixed-size allocation (see
+// transform_to_chunked); AoSoA/SoA retiles leave it alone and return false.
+enum class LayoutKind : std::uint8_t { AoS=0, SoA=1, AoSoA=2, Matrix=3, MortonSorted=4, Chunked=5, Partitioned=6 };
 
 struct RetilePlan {
   LayoutKind to = LayoutKind::SoA;
@@ -18,8 +22,10 @@ LayoutKind current_layout(ViewId v);
 
 RetilePlan plan_aosoa(ViewId v, int tile);
 RetilePlan plan_matrix(ViewId v, int block);
+RetilePlan plan_sort_morton(ViewId v); // keyed on the Position component
+RetilePlan plan_partition_by_mask(ViewId v, std::uint32_t mask); // keyed on Flags.mask; tile_or_block holds the mask
 
-bool retile(ViewId v, const RetilePlan& plan);
+bool retile(ViewId v, const RetilePlan& plan); // false when the plan did not apply
 bool retile_to_soa(ViewId v);
 
 } // namespace dynsoa
@@ -0,0 +1,51 @@
+// DynSoA Runtime SDK
+
+#pragma once
+#include "types.h"
+#include <cstddef>
+
+namespace dynsoa {
+
+// Placement of view storage (column buffers and chunks), set from Config by
+// dynsoa_init. Takes effect for storage allocated afterwards.
+//
+// FirstTouch leaves pages on whichever node writes them first. Interleave
+// spreads a view across every node: contiguous buffers page by page, chunked
+// views in stripes of kNumaStripeChunks consecutive chunks per node; pool
+// workers are then pinned to nodes and parallel kernels seed each task on a
+// worker local to its chunks. Bind places all storage on one node.
+//
+// HugePages::Transparent aligns buffers of at least kHugePageBytes to it and
+// advises transparent huge pages; Explicit maps them from the hugetlbfs pool
+// and falls back to Transparent when the pool is empty.
+//
+// Placement uses Linux mbind/madvise; elsewhere, and on single-node hosts,
+// the NUMA policies behave as FirstTouch.
+constexpr std::size_t kHugePageBytes    = std::size_t(2) << 20;
+constexpr std::size_t kNumaStripeChunks = 64;
+
+struct MemoryPolicy {
+  NumaPolicy numa = NumaPolicy::FirstTouch;
+  int        node = 0; // for NumaPolicy::Bind; out-of-range values mean node 0
+  HugePages  huge_pages = HugePages::Off;
+};
+
+void         set_memory_policy(const MemoryPolicy& p);
+MemoryPolicy memory_policy();
+
+int  numa_node_count();        // 1 when NUMA is unavailable
+int  numa_node_of_cpu(int cpu); // 0 when unknown
+// Restrict the calling thread to the CPUs of `node`; false if not possible.
+bool numa_pin_thread(int node);
+// True when Interleave is active on a multi-node host, i.e. when chunks have
+// home nodes and pool workers are pinned.
+bool numa_striping();
+
+// Storage allocation under the current policy. node >= 0 places the block
+// on that node (a chunk's stripe) instead of applying the policy.
+void* storage_alloc(std::size_t bytes, std::size_t align, int node = -1);
+void  storage_free(void* p);
+// Move an existing block's pages to `node` (reused chunks changing stripe).
+void  storage_place(void* p, std::size_t bytes, int node);
+
+} // namespace dynsoa
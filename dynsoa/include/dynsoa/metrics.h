@@ -14,12 +14,43 @@ struct Sample {
   float mem_coalesce = 1.f;
   float l2_miss_rate = 0.f;
   std::uint32_t time_us = 0;
-  std::uint32_t p95_tile_us = 0;
+  std::uint32_t p95_tile_us = 0; // 0 when the run had no per-tile timings (serial run_kernel)
   std::uint32_t p99_tile_us = 0;
+  // CPU hardware counter totals (0 when perf counters are unavailable)
+  std::uint64_t cpu_instructions  = 0;
+  std::uint64_t cpu_branch_misses = 0;
+  std::uint64_t cpu_cache_misses  = 0;
+  std::uint64_t cpu_llc_misses    = 0;
 };
 
+// Fixed-bucket, log-linear tile latency histogram (HDR-style): kSub linear
+// sub-buckets per power of two of nanoseconds, ~1/kSub relative error, no
+// allocation. One per worker, kept across kernel invocations and reset per
+// run; merged before emitting.
+struct TileHistogram {
+  static constexpr int kSubBits = 4;
+  static constexpr int kSub     = 1 << kSubBits;
+  static constexpr int kBuckets = (64 - kSubBits + 1) * kSub;
+
+  std::uint32_t counts[kBuckets] = {};
+  std::uint32_t total = 0;
+
+  void          record(std::uint64_t ns);
+  void          merge(const TileHistogram& o);
+  void          reset();
+  std::uint64_t percentile_ns(double q) const; // upper edge of the bucket holding quantile q
+};
+
+// Emission is wait-free on the calling thread: samples go into a per-thread
+// ring that a background thread drains into the CSV (written in batches) and
+// the aggregation windows. The drainer sleeps until a ring is half full (or
+// for at most a second); the scheduler flushes at frame end. A full ring
+// drops the sample (see metrics_dropped).
 void metrics_enable_csv(const char* path);
 void emit_metric(const Sample& s);
+void          metrics_flush();    // drain every ring now; aggregate() then sees all prior samples
+void          metrics_shutdown(); // stop the drainer for good and flush the CSV
+std::uint64_t metrics_dropped();
 
 FrameAgg aggregate(ViewId v, int window_frames);
 void     metrics_note_frame_end(ViewId v, const Sample& s);
@@ -0,0 +1,43 @@
+// DynSoA Runtime SDK
+
+#pragma once
+#include <cstdint>
+
+namespace dynsoa {
+
+struct Sample;
+
+// Hardware counter totals for one measured region (Linux perf_event_open).
+struct PerfCounts {
+  std::uint64_t instructions  = 0;
+  std::uint64_t branches      = 0;
+  std::uint64_t branch_misses = 0;
+  std::uint64_t cache_refs    = 0;
+  std::uint64_t cache_misses  = 0;
+  std::uint64_t llc_misses    = 0;
+  std::uint64_t time_enabled  = 0; // ns the group was enabled
+  std::uint64_t time_running  = 0; // ns it was actually on the PMU
+  bool          valid = false;
+
+  void add(const PerfCounts& o);
+};
+
+// True when the calling thread has a working counter group. Counters are
+// opened lazily per thread; if the kernel refuses (containers, paranoid
+// settings, non-Linux) this stays false and Samples keep their defaults.
+// DYNSOA_PERF=0 disables the backend entirely.
+bool perf_thread_available();
+
+// Cumulative counts for the calling thread; take the difference of two reads.
+// perf_delta scales the counts up when the group was multiplexed off the PMU
+// for part of the window, and returns an invalid delta when it never ran.
+PerfCounts perf_thread_read();
+PerfCounts perf_delta(const PerfCounts& before, const PerfCounts& after);
+
+// Map counts onto the Sample fields (branch_div, mem_coalesce, l2_miss_rate
+// and the cpu_* totals). branch_div is the branch-mispredict rate scaled x10
+// (capped at 1) into the range of warp divergence the policy thresholds
+// expect; cpu_branch_misses keeps the raw count. No-op when `c` is not valid.
+void perf_fill_sample(const PerfCounts& c, Sample& s);
+
+} // namespace dynsoa
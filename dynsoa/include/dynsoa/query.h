@@ -0,0 +1,22 @@
+// DynSoA Runtime SDK
+
+#pragma once
+#include "types.h"
+#include <cstddef>
+#include <vector>
+
+namespace dynsoa {
+
+// A query matches every archetype whose components include the required set
+// and keeps the matched views in a cached list. Archetypes are only ever
+// appended, so the cache is refreshed incrementally: each lookup tests just
+// the archetypes defined since the previous one (including those created by
+// add_component/remove_component). Matching creates the archetype's view.
+QueryId make_query(const char** components, int count);
+
+// Matched views in archetype definition order. Returned by value: kernels
+// and command flushes may define archetypes or queries while a caller is
+// still walking the list.
+std::vector<ViewId> query_views(QueryId q);
+
+} // namespace dynsoa
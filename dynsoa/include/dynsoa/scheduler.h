@@ -16,8 +16,9 @@ struct LearnState {
 
 struct PolicyTrigger {
   std::string when;     // e.g., "branch_div > 0.2 && warp_eff < 0.8"
-  std::string action;   // "RETILE_AOSOA" | "RETILE_SOA" | "PACK_MATRIX"
-  int         arg = 0;  // tile or block
+  std::string action;   // "RETILE_AOSOA" | "RETILE_SOA" | "PACK_MATRIX" | "RETILE_SORT_MORTON"
+                        // | "PARTITION_BY_MASK" | "AUTO" (UCB bandit over the action catalog)
+  int         arg = 0;  // tile, block, or flag mask (0 = all bits)
   double      priority = 1.0;
 };
 struct Policy {
@@ -12,7 +12,36 @@ struct ArchetypeDesc {
   std::vector<std::string> components;
 };
 
+// Owned copy of a registered Component (callers may free their Field arrays
+// right after define_component returns, e.g. the Unity bindings do).
+struct FieldDesc {
+  std::string name;
+  ScalarType  type = ScalarType::F32;
+};
+struct ComponentDesc {
+  std::string name;
+  std::vector<FieldDesc> fields;
+};
+
 void define_component(const Component& c);
 ArchetypeId define_archetype(const char* name, const char** components, int count);
 
+const ArchetypeDesc*  find_archetype(ArchetypeId arch);
+std::size_t           archetype_count(); // ids are 1..archetype_count()
+
+// Archetype graph: the archetype holding arch's components plus (or minus)
+// one component. An existing archetype with that component set is reused,
+// otherwise one is defined. Each edge is cached on first use, so repeated
+// transitions resolve in O(1). Returns arch itself when nothing changes and
+// 0 for an unknown archetype.
+ArchetypeId archetype_with(ArchetypeId arch, const char* component);
+ArchetypeId archetype_without(ArchetypeId arch, const char* component);
+const ComponentDesc*  find_component(const std::string& name);
+
+// Column path for a component field, e.g. "Position" + "x" -> "Position.x".
+// Fields that are already qualified ("Position.x") are used as-is.
+std::string column_path(const std::string& comp, const std::string& field);
+
+std::size_t scalar_size(ScalarType t);
+
 } // namespace dynsoa
@@ -0,0 +1,63 @@
+// DynSoA Runtime SDK
+
+#pragma once
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace dynsoa {
+
+// Vectorized column primitives. The implementation is chosen once per
+// process from cpuid (AVX-512F, AVX2, else scalar on x86; NEON on AArch64),
+// so one binary runs the widest path the host supports. DYNSOA_SIMD=scalar,
+// neon, avx2 or avx512 caps the choice for A/B runs; any other value is
+// reported on stderr and ignored.
+//
+// Element-wise primitives give bit-identical results on every path (no FMA
+// contraction). Reductions combine lanes in a different order than a serial
+// loop, so sums may differ from it in the last bits.
+enum class SimdLevel : std::uint8_t { Scalar=0, NEON=1, AVX2=2, AVX512=3 };
+
+SimdLevel   simd_level();
+const char* simd_level_name(SimdLevel l);
+// Runs the element-wise primitives on the selected path and on the scalar
+// one over the same inputs; true when every output matches bit for bit.
+bool        simd_matches_scalar();
+
+// y[i] += a * x[i]
+void  simd_axpy(float* y, const float* x, float a, std::size_t n);
+// y[i] += a * x[i] where (flags[i] & mask) != 0
+void  simd_axpy_masked(float* y, const float* x, float a,
+                       const std::uint32_t* flags, std::uint32_t mask, std::size_t n);
+// Scale each (x, y, z) row whose length exceeds max_len back to max_len.
+void  simd_clamp_length(float* x, float* y, float* z, float max_len, std::size_t n);
+
+float simd_sum(const float* x, std::size_t n);
+float simd_min(const float* x, std::size_t n); // +inf for n == 0
+float simd_max(const float* x, std::size_t n); // -inf for n == 0
+
+// out[i] = src[idx[i]]  /  dst[idx[i]] = src[i] (later i wins on duplicates).
+// Any uint32_t index is valid: vectors with an index >= 2^31, which the x86
+// gathers would read as negative, take the scalar loop.
+void  simd_gather(float* out, const float* src, const std::uint32_t* idx, std::size_t n);
+void  simd_scatter(float* dst, const float* src, const std::uint32_t* idx, std::size_t n);
+
+// Column forms over rows [begin, end) of an F32 column, applied tile by tile
+// so they are valid in every layout. Written columns are marked changed. A
+// column of another type (or an invalid id) makes the call a no-op, and the
+// reductions return their n == 0 value; masked axpy takes a U32 or I32 flags
+// column.
+void  column_axpy(ViewId v, ColumnId y, ColumnId x, float a, std::size_t begin, std::size_t end);
+void  column_axpy_masked(ViewId v, ColumnId y, ColumnId x, float a, ColumnId flags, std::uint32_t mask,
+                         std::size_t begin, std::size_t end);
+void  column_clamp_length(ViewId v, ColumnId x, ColumnId y, ColumnId z, float max_len,
+                          std::size_t begin, std::size_t end);
+// out[i] = c[rows[i]]  /  c[rows[i]] = src[i], for view rows in any order.
+// Rows past view_len gather 0 and are skipped by the scatter.
+void  column_gather(ViewId v, ColumnId c, const std::uint32_t* rows, float* out, std::size_t n);
+void  column_scatter(ViewId v, ColumnId c, const std::uint32_t* rows, const float* src, std::size_t n);
+float column_sum(ViewId v, ColumnId c);
+float column_min(ViewId v, ColumnId c);
+float column_max(ViewId v, ColumnId c);
+
+} // namespace dynsoa
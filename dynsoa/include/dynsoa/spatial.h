@@ -0,0 +1,52 @@
+// DynSoA Runtime SDK
+
+#pragma once
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dynsoa {
+
+// Slots [begin, end) of a SpatialGrid's cell-sorted arrays.
+struct GridRange {
+  std::uint32_t begin;
+  std::uint32_t end;
+};
+
+// Uniform spatial hash grid, rebuilt from scratch each frame with a counting
+// sort. Cells are cubes of cell_size hashed into a power-of-two bucket table,
+// so the world needs no bounds. After a build, the entities of one bucket
+// occupy consecutive slots: x/y/z hold their positions and order maps slot ->
+// row, so neighbour loops stream contiguous memory instead of chasing rows.
+struct SpatialGrid {
+  float cell_size = 1.f;
+  float inv_cell  = 1.f;
+  std::uint32_t mask = 0;                 // bucket count - 1
+  std::vector<std::uint32_t> cell_start;  // bucket b holds slots [cell_start[b], cell_start[b+1])
+  std::vector<std::uint32_t> order;       // slot -> row
+  std::vector<float> x, y, z;             // positions in slot order
+  std::vector<std::uint32_t> bucket_of;   // row -> bucket (build scratch)
+
+  std::size_t size() const { return order.size(); }
+};
+
+// Build over n points read at byte stride from x/y/z (sizeof(float) for SoA
+// arrays, sizeof(T) for an array of structs).
+void grid_build(SpatialGrid& g, const float* x, const float* y, const float* z,
+                std::size_t n, std::size_t stride_bytes, float cell_size);
+// Build over a view's position columns; valid in any layout.
+void grid_build(SpatialGrid& g, ViewId v, ColumnId x, ColumnId y, ColumnId z, float cell_size);
+
+// Reorder a per-row float column into slot order (e.g. velocities read by the
+// neighbour loop). out is resized to g.size().
+void grid_gather(const SpatialGrid& g, ViewId v, ColumnId c, std::vector<float>& out);
+
+// Slot ranges of every non-empty bucket that may hold points within radius of
+// (px, py, pz), each bucket listed once; with radius <= cell_size there are at
+// most 27. Writes up to max_out ranges and returns the number found; a result
+// above max_out means the list was truncated (the count is then an upper bound).
+int grid_query(const SpatialGrid& g, float px, float py, float pz, float radius,
+               GridRange* out, int max_out);
+
+} // namespace dynsoa
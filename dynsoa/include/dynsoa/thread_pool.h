@@ -0,0 +1,22 @@
+// DynSoA Runtime SDK
+
+#pragma once
+#include <cstddef>
+
+namespace dynsoa {
+
+// Persistent work-stealing pool shared by the parallel kernel paths.
+// Worker count comes from DYNSOA_THREADS (default: hardware concurrency);
+// the calling thread takes part as worker 0.
+using PoolTaskFn = void (*)(void* arg, std::size_t task, int worker);
+
+int  pool_workers();
+// Run fn(arg, t, worker) for every t in [0, tasks) and block until all are done.
+// Calls made from inside a pool task run inline on the calling thread.
+// task_node, if given, holds each task's NUMA node (-1 for none): while
+// workers are pinned to nodes (see numa_striping) tasks are seeded on workers
+// of their node. Idle workers still steal across nodes.
+void pool_run(std::size_t tasks, PoolTaskFn fn, void* arg, const int* task_node = nullptr);
+void pool_shutdown();
+
+} // namespace dynsoa
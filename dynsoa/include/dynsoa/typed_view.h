@@ -0,0 +1,187 @@
+// DynSoA Runtime SDK
+
+#pragma once
+#include "dynsoa.h"
+#include <array>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// Header-only typed access on top of the C column API. A component binding
+// names a registered component and its fields, all of one scalar type:
+//
+//   struct Velocity {
+//     using scalar = float;
+//     static constexpr const char* name = "Velocity";
+//     static constexpr const char* fields[] = {"vx", "vy", "vz"};
+//   };
+//
+// TypedView<Position, Velocity> resolves every field's ColumnId once, and
+// for_each_tile hands the kernel aligned per-field lane pointers. Full tiles
+// of the common AoSoA widths get the row count as a compile-time constant, so
+// the inner loop has a fixed trip count:
+//
+//   TypedView<Position, const Velocity> tv(v);
+//   tv.for_each_tile([&](auto n, auto pos, auto vel) {
+//     restrict_ptr<float> px = pos[0];
+//     restrict_ptr<const float> vx = vel[0];
+//     for (std::size_t i = 0; i < n; ++i) px[i] += vx[i] * dt;
+//   });
+//
+// A const-qualified binding hands out const lane pointers. Every other
+// component counts as written: for_each_tile marks its columns changed over
+// the visited rows (see mark_changed).
+//
+// Keep lane pointers in restrict_ptr locals; the qualifier only reaches the
+// optimizer through a named pointer.
+
+#if defined(_MSC_VER) || defined(__GNUC__) || defined(__clang__)
+  #define DYNSOA_RESTRICT __restrict
+#else
+  #define DYNSOA_RESTRICT
+#endif
+
+namespace dynsoa {
+
+template <class T>
+using restrict_ptr = T* DYNSOA_RESTRICT;
+
+template <std::size_t N, class T>
+inline T* assume_aligned(T* p) {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<T*>(__builtin_assume_aligned(p, N));
+#else
+  return p;
+#endif
+}
+
+// AoSoA tile widths that get a fixed-trip-count instantiation.
+using SpecializedTileRows = std::index_sequence<32, 64, 128, 256, 512>;
+
+template <class C>
+constexpr std::size_t component_fields = std::extent<decltype(C::fields)>::value;
+
+template <class C>
+using component_scalar = std::conditional_t<std::is_const<C>::value, const typename C::scalar, typename C::scalar>;
+
+// Lane pointers of one component's fields inside one tile. Aligned is true
+// when the pointers start at lane 0, i.e. on a kColumnAlign boundary.
+template <class C, bool Aligned>
+struct ComponentTile {
+  using scalar = component_scalar<C>;
+  std::array<scalar*, component_fields<C>> lanes{};
+
+  scalar* operator[](std::size_t field) const {
+    return Aligned ? assume_aligned<kColumnAlign>(lanes[field]) : lanes[field];
+  }
+};
+
+template <class... Cs>
+class TypedView {
+ public:
+  explicit TypedView(ViewId v) : view_(v) {
+    resolve(std::index_sequence_for<Cs...>{});
+  }
+
+  ViewId      view() const      { return view_; }
+  std::size_t size() const      { return dynsoa_view_len(view_); }
+  std::size_t tile_rows() const { return dynsoa_view_tile_rows(view_); }
+  // False if any bound field has no column in the view.
+  bool        valid() const     { return valid_; }
+
+  ColumnId column(std::size_t component, std::size_t field) const { return ids_[offset(component) + field]; }
+
+  // Calls fn(n, ComponentTile<Cs>...) for every tile piece of rows
+  // [begin, end). n is std::integral_constant<size_t, T> for full tiles of a
+  // specialized width T, else std::size_t.
+  template <class Fn>
+  void for_each_tile(std::size_t begin, std::size_t end, Fn&& fn) const {
+    if (!valid_) return;
+    const std::size_t T = tile_rows();
+    if (T == 0) return;
+    if (end > size()) end = size();
+    if (!dispatch_fixed(T, begin, end, fn, SpecializedTileRows{}))
+      walk<0>(T, begin, end, fn);
+    mark_written(begin, end, std::index_sequence_for<Cs...>{});
+  }
+
+  template <class Fn>
+  void for_each_tile(Fn&& fn) const { for_each_tile(0, size(), std::forward<Fn>(fn)); }
+
+ private:
+  static constexpr std::size_t kColumns = (component_fields<Cs> + ... + 0);
+
+  static constexpr std::size_t offset(std::size_t component) {
+    constexpr std::size_t counts[] = {component_fields<Cs>..., 0};
+    std::size_t o = 0;
+    for (std::size_t i = 0; i < component; ++i) o += counts[i];
+    return o;
+  }
+
+  template <std::size_t... I>
+  void resolve(std::index_sequence<I...>) {
+    (resolve_component<Cs>(offset(I)), ...);
+  }
+
+  template <class C>
+  void resolve_component(std::size_t base) {
+    for (std::size_t f = 0; f < component_fields<C>; ++f) {
+      const std::string path = std::string(C::name) + "." + C::fields[f];
+      ids_[base + f] = dynsoa_column_id(view_, path.c_str());
+      valid_ = valid_ && ids_[base + f] != kInvalidColumn;
+    }
+  }
+
+  template <class C, bool Aligned>
+  ComponentTile<C, Aligned> tile_of(std::size_t base, std::size_t k, std::size_t lane) const {
+    ComponentTile<C, Aligned> t;
+    for (std::size_t f = 0; f < component_fields<C>; ++f)
+      t.lanes[f] = static_cast<component_scalar<C>*>(dynsoa_column_tile(view_, ids_[base + f], k)) + lane;
+    return t;
+  }
+
+  template <std::size_t... I>
+  void mark_written(std::size_t begin, std::size_t end, std::index_sequence<I...>) const {
+    if (begin >= end) return;
+    auto mark = [&](std::size_t base, std::size_t fields, bool written) {
+      if (!written) return;
+      for (std::size_t f = 0; f < fields; ++f) dynsoa_mark_changed(view_, ids_[base + f], begin, end);
+    };
+    (mark(offset(I), component_fields<Cs>, !std::is_const<Cs>::value), ...);
+  }
+
+  template <bool Aligned, class N, class Fn, std::size_t... I>
+  void call(Fn& fn, N n, std::size_t k, std::size_t lane, std::index_sequence<I...>) const {
+    fn(n, tile_of<Cs, Aligned>(offset(I), k, lane)...);
+  }
+
+  // Full tiles pass N as a constant when FixedRows != 0; a leading partial
+  // tile (unaligned begin) and the trailing remainder pass a runtime count.
+  template <std::size_t FixedRows, class Fn>
+  void walk(std::size_t T, std::size_t begin, std::size_t end, Fn& fn) const {
+    const auto seq = std::index_sequence_for<Cs...>{};
+    for (std::size_t r = begin; r < end;) {
+      const std::size_t k = r / T, lane = r - k * T;
+      const std::size_t n = (T - lane < end - r) ? T - lane : end - r;
+      r += n;
+      if (lane != 0) { call<false>(fn, n, k, lane, seq); continue; }
+      if constexpr (FixedRows != 0) {
+        if (n == FixedRows) { call<true>(fn, std::integral_constant<std::size_t, FixedRows>{}, k, 0, seq); continue; }
+      }
+      call<true>(fn, n, k, 0, seq);
+    }
+  }
+
+  template <class Fn, std::size_t... W>
+  bool dispatch_fixed(std::size_t T, std::size_t begin, std::size_t end, Fn& fn,
+                      std::index_sequence<W...>) const {
+    return ((T == W ? (walk<W>(T, begin, end, fn), true) : false) || ...);
+  }
+
+  ViewId view_;
+  bool   valid_ = true;
+  std::array<ColumnId, kColumns> ids_{};
+};
+
+} // namespace dynsoa
@@ -8,9 +8,18 @@ namespace dynsoa {
 
 using ArchetypeId = std::uint64_t;
 using ViewId      = std::uint64_t;
+using ColumnId    = std::int32_t;  // per-view column handle, stable for the view's lifetime
+
+using EntityId    = std::uint64_t; // (generation << 32) | slot; see entity_store.h
+using QueryId     = std::uint64_t; // 1-based, 0 = invalid; see query.h
+
+constexpr ColumnId kInvalidColumn = -1;
+constexpr EntityId kInvalidEntity = 0;   // generations start at 1, so no live handle is 0
 
 enum class Device : std::uint8_t { CPU = 0, GPU = 1 };
 enum class ScalarType : std::uint8_t { F32=0, I32=1, U32=2, F64=3, I64=4 };
+enum class NumaPolicy : std::uint8_t { FirstTouch=0, Interleave=1, Bind=2 };  // see memory.h
+enum class HugePages  : std::uint8_t { Off=0, Transparent=1, Explicit=2 };
 
 struct Config {
   Device device = Device::CPU;
@@ -18,6 +27,10 @@ struct Config {
   int matrix_block = 1024;
   int max_retile_us = 500;
   bool scheduler_enabled = false;
+  int column_align = 64; // bytes, base alignment of view storage; 0 = default, 2 MiB for huge pages
+  NumaPolicy numa = NumaPolicy::FirstTouch;
+  int numa_node = 0;     // target of NumaPolicy::Bind
+  HugePages huge_pages = HugePages::Off;
 };
 
 struct Field { const char* name; ScalarType type; };
@@ -30,13 +43,19 @@ struct Component {
 
 struct KernelCtx { float dt; int tile; };
 
+enum MatrixBlockFlags : unsigned {
+  kMatrixBlockZeroCopy = 1u << 0, // alias view storage when the layout is already column-major
+};
+
 struct MatrixBlock {
-  float* data = nullptr;  // column-major (M[j*rows + i])
+  float* data = nullptr;  // column-major (M[j*leading_dim + i])
   int    rows = 0;        // B
   int    cols = 0;        // K
-  int    leading_dim = 0; // rows == leading_dim
+  int    leading_dim = 0; // == rows for pooled copies; column stride for zero-copy blocks
   std::size_t bytes = 0;
   std::size_t offset = 0;
+  void*    header = nullptr; // pooled header (source columns, copy buffer); null when nothing was acquired
+  unsigned flags = 0;        // kMatrixBlockZeroCopy when data aliases view storage
 };
 
 struct FrameAgg {
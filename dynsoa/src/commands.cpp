@@ -0,0 +1,136 @@
+// DynSoA Runtime SDK
+
+#include "dynsoa/commands.h"
+#include "dynsoa/entity_store.h"
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace dynsoa {
+
+namespace {
+
+struct SpawnCmd {
+  ArchetypeId arch;
+  std::size_t count;
+  void (*init_fn)(std::size_t, void*);
+};
+
+struct DestroyCmd {
+  ViewId   view;
+  EntityId entity;
+};
+
+struct ComponentCmd {
+  ViewId      view;
+  std::string component;
+  bool        add;
+  EntityId    entity;
+};
+
+// The owning thread and commands_flush are the only users of `mu`, so
+// recording is an uncontended lock plus a vector push.
+struct CommandBuffer {
+  std::mutex mu;
+  std::vector<SpawnCmd>   spawns;
+  std::vector<DestroyCmd> destroys;
+  std::vector<ComponentCmd> changes;
+};
+
+struct Registry {
+  std::mutex mu;
+  std::vector<std::unique_ptr<CommandBuffer>> buffers; // kept for the process lifetime
+};
+
+Registry& registry() {
+  static Registry r;
+  return r;
+}
+
+thread_local CommandBuffer* t_buffer = nullptr;
+
+CommandBuffer& thread_buffer() {
+  if (t_buffer) return *t_buffer;
+  Registry& R = registry();
+  std::lock_guard<std::mutex> lk(R.mu);
+  R.buffers.push_back(std::make_unique<CommandBuffer>());
+  t_buffer = R.buffers.back().get();
+  return *t_buffer;
+}
+
+} // namespace
+
+void cmd_spawn(ArchetypeId arch, std::size_t count, void(*init_fn)(std::size_t, void*)) {
+  if (count == 0) return;
+  CommandBuffer& B = thread_buffer();
+  std::lock_guard<std::mutex> lk(B.mu);
+  B.spawns.push_back({arch, count, init_fn});
+}
+
+void cmd_destroy(ViewId v, EntityId e) {
+  CommandBuffer& B = thread_buffer();
+  std::lock_guard<std::mutex> lk(B.mu);
+  B.destroys.push_back({v, e});
+}
+
+static void record_change(ViewId v, EntityId e, const char* component, bool add) {
+  if (!component) return;
+  CommandBuffer& B = thread_buffer();
+  std::lock_guard<std::mutex> lk(B.mu);
+  B.changes.push_back({v, component, add, e});
+}
+
+void cmd_add_component(ViewId v, EntityId e, const char* component)    { record_change(v, e, component, true); }
+void cmd_remove_component(ViewId v, EntityId e, const char* component) { record_change(v, e, component, false); }
+
+void commands_flush() {
+  std::vector<DestroyCmd>   destroys;
+  std::vector<ComponentCmd> changes;
+  std::vector<SpawnCmd>     spawns;
+  {
+    Registry& R = registry();
+    std::lock_guard<std::mutex> lk(R.mu);
+    for (auto& B : R.buffers) {
+      std::lock_guard<std::mutex> bl(B->mu);
+      destroys.insert(destroys.end(), B->destroys.begin(), B->destroys.end());
+      spawns.insert(spawns.end(), B->spawns.begin(), B->spawns.end());
+      std::move(B->changes.begin(), B->changes.end(), std::back_inserter(changes));
+      B->destroys.clear();
+      B->changes.clear();
+      B->spawns.clear();
+    }
+  }
+
+  // One destroy_entities call per view, so each view is compacted once.
+  std::stable_sort(destroys.begin(), destroys.end(),
+                   [](const DestroyCmd& a, const DestroyCmd& b){ return a.view < b.view; });
+  std::vector<EntityId> batch;
+  for (std::size_t i = 0; i < destroys.size();) {
+    const ViewId v = destroys[i].view;
+    batch.clear();
+    for (; i < destroys.size() && destroys[i].view == v; ++i) batch.push_back(destroys[i].entity);
+    destroy_entities(v, batch.data(), batch.size());
+  }
+
+  // One migration per (view, component, direction).
+  auto key = [](const ComponentCmd& c){ return std::tie(c.view, c.component, c.add); };
+  std::stable_sort(changes.begin(), changes.end(),
+                   [&](const ComponentCmd& a, const ComponentCmd& b){ return key(a) < key(b); });
+  for (std::size_t i = 0; i < changes.size();) {
+    const ComponentCmd& head = changes[i];
+    batch.clear();
+    std::size_t j = i;
+    for (; j < changes.size() && key(changes[j]) == key(head); ++j) batch.push_back(changes[j].entity);
+    if (head.add) add_component(head.view, batch.data(), batch.size(), head.component.c_str());
+    else          remove_component(head.view, batch.data(), batch.size(), head.component.c_str());
+    i = j;
+  }
+
+  for (const auto& s : spawns) spawn(s.arch, s.count, s.init_fn);
+}
+
+} // namespace dynsoa
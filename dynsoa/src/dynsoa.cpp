@@ -2,6 +2,7 @@
 
 #include "dynsoa/dynsoa.h"
 #include <mutex>
+#include <string>
 
 namespace {
   dynsoa::Config g_cfg;
@@ -17,6 +18,8 @@ extern "C" {
 void dynsoa_init(const dynsoa::Config* cfg) {
   std::call_once(g_once, [&]{
     if (cfg) g_cfg = *cfg;
+    if (g_cfg.column_align > 0) dynsoa::set_column_alignment((std::size_t)g_cfg.column_align);
+    dynsoa::set_memory_policy({g_cfg.numa, g_cfg.numa_node, g_cfg.huge_pages});
     dynsoa::scheduler_load_state(); // load learned weights
     g_inited = true;
   });
@@ -25,6 +28,8 @@ void dynsoa_init(const dynsoa::Config* cfg) {
 void dynsoa_shutdown() {
   if (g_inited) {
     dynsoa::scheduler_save_state(); // persist learned weights
+    dynsoa::pool_shutdown();
+    dynsoa::metrics_shutdown();
     g_inited = false;
   }
 }
@@ -43,10 +48,51 @@ dynsoa::ArchetypeId dynsoa_define_archetype(const char* n, const char** comps, i
 void* dynsoa_spawn(dynsoa::ArchetypeId a, size_t n, void(*init_fn)(size_t,void*)) {
   return dynsoa::spawn(a, n, init_fn);
 }
+size_t dynsoa_spawn_bulk(dynsoa::ArchetypeId a, size_t n, dynsoa::SpawnInitFn init_fn, void* user) {
+  return dynsoa::spawn_bulk(a, n, init_fn, user);
+}
 
 dynsoa::ViewId dynsoa_make_view(dynsoa::ArchetypeId a) { return dynsoa::make_view(a); }
 size_t         dynsoa_view_len(dynsoa::ViewId v)       { return dynsoa::view_len(v); }
 void*          dynsoa_column(dynsoa::ViewId v, const char* p) { return dynsoa::column(v, p); }
+dynsoa::ColumnId dynsoa_column_id(dynsoa::ViewId v, const char* p)  { return dynsoa::column_id(v, p); }
+void*          dynsoa_column_ptr(dynsoa::ViewId v, dynsoa::ColumnId c) { return dynsoa::column_ptr(v, c); }
+size_t         dynsoa_view_tile_rows(dynsoa::ViewId v)  { return dynsoa::view_tile_rows(v); }
+void*          dynsoa_column_tile(dynsoa::ViewId v, dynsoa::ColumnId c, size_t k) { return dynsoa::column_tile(v, c, k); }
+size_t         dynsoa_view_capacity(dynsoa::ViewId v)   { return dynsoa::view_capacity(v); }
+size_t         dynsoa_view_padded_len(dynsoa::ViewId v) { return dynsoa::view_padded_len(v); }
+
+dynsoa::ColumnId dynsoa_set_double_buffered(dynsoa::ViewId v, dynsoa::ColumnId c) { return dynsoa::set_double_buffered(v, c); }
+dynsoa::ColumnId dynsoa_column_next(dynsoa::ViewId v, dynsoa::ColumnId c)         { return dynsoa::column_next(v, c); }
+int              dynsoa_numa_node_count()                                         { return dynsoa::numa_node_count(); }
+int              dynsoa_view_row_node(dynsoa::ViewId v, size_t row)              { return dynsoa::view_row_node(v, row); }
+
+uint64_t dynsoa_change_clock() { return dynsoa::change_clock(); }
+size_t   dynsoa_change_block_rows(dynsoa::ViewId v) { return dynsoa::change_block_rows(v); }
+void     dynsoa_mark_changed(dynsoa::ViewId v, dynsoa::ColumnId c, size_t b, size_t e) { dynsoa::mark_changed(v, c, b, e); }
+uint64_t dynsoa_column_version(dynsoa::ViewId v, dynsoa::ColumnId c) { return dynsoa::column_version(v, c); }
+size_t   dynsoa_changed_blocks(dynsoa::ViewId v, const dynsoa::ColumnId* cols, int k, uint64_t since,
+                               uint32_t* out, size_t max_out) {
+  return dynsoa::changed_blocks(v, cols, k, since, out, max_out);
+}
+
+dynsoa::EntityId dynsoa_entity_at(dynsoa::ViewId v, size_t row)          { return dynsoa::row_entity(v, row); }
+size_t           dynsoa_entity_row(dynsoa::ViewId v, dynsoa::EntityId e) { return dynsoa::entity_row(v, e); }
+int              dynsoa_destroy_entity(dynsoa::ViewId v, dynsoa::EntityId e) { return dynsoa::destroy_entity(v, e) ? 1 : 0; }
+size_t           dynsoa_destroy_entities(dynsoa::ViewId v, const dynsoa::EntityId* es, size_t n) {
+  return dynsoa::destroy_entities(v, es, n);
+}
+size_t dynsoa_add_component(dynsoa::ViewId v, const dynsoa::EntityId* es, size_t n, const char* c, dynsoa::EntityId* out) {
+  return dynsoa::add_component(v, es, n, c, out);
+}
+size_t dynsoa_remove_component(dynsoa::ViewId v, const dynsoa::EntityId* es, size_t n, const char* c, dynsoa::EntityId* out) {
+  return dynsoa::remove_component(v, es, n, c, out);
+}
+
+void dynsoa_cmd_spawn(dynsoa::ArchetypeId a, size_t n, void(*init_fn)(size_t,void*)) { dynsoa::cmd_spawn(a, n, init_fn); }
+void dynsoa_cmd_destroy(dynsoa::ViewId v, dynsoa::EntityId e) { dynsoa::cmd_destroy(v, e); }
+void dynsoa_cmd_add_component(dynsoa::ViewId v, dynsoa::EntityId e, const char* c)    { dynsoa::cmd_add_component(v, e, c); }
+void dynsoa_cmd_remove_component(dynsoa::ViewId v, dynsoa::EntityId e, const char* c) { dynsoa::cmd_remove_component(v, e, c); }
 
 // ---------------------------------------------------
 // Retile helpers / matrix blocks
@@ -58,16 +104,57 @@ int dynsoa_retile_to_soa(dynsoa::ViewId v) {
   return dynsoa::retile_to_soa(v) ? 1 : 0;
 }
 
+int dynsoa_retile_sort_morton(dynsoa::ViewId v) {
+  return dynsoa::retile(v, dynsoa::plan_sort_morton(v)) ? 1 : 0;
+}
+
+int dynsoa_partition_by_mask(dynsoa::ViewId v, const char* path, uint32_t mask) {
+  return dynsoa::transform_partition_by_mask(v, path, mask) ? 1 : 0;
+}
+int dynsoa_view_partitions(dynsoa::ViewId v, dynsoa::RowPartition* out, int max_out) {
+  return dynsoa::view_partitions(v, out, max_out);
+}
+
+size_t dynsoa_set_chunked(dynsoa::ViewId v, size_t chunk_bytes) {
+  return dynsoa::transform_to_chunked(v, chunk_bytes ? chunk_bytes : dynsoa::kDefaultChunkBytes);
+}
+
 void* dynsoa_acquire_matrix_block(dynsoa::ViewId v, const char** comps, int k, int rows,
                                   size_t offset, dynsoa::MatrixBlock* out) {
   auto mb = dynsoa::acquire_matrix_block(v, comps, k, rows, offset);
   if (out) *out = mb;
   return (void*)mb.data;
 }
+void* dynsoa_acquire_matrix_block_ex(dynsoa::ViewId v, const char** comps, int k, int rows,
+                                     size_t offset, unsigned flags, dynsoa::MatrixBlock* out) {
+  auto mb = dynsoa::acquire_matrix_block(v, comps, k, rows, offset, flags);
+  if (out) *out = mb;
+  return (void*)mb.data;
+}
 void dynsoa_release_matrix_block(dynsoa::ViewId v, dynsoa::MatrixBlock* mb, int write_back) {
   dynsoa::release_matrix_block(v, mb, write_back != 0);
 }
 
+// ---------------------------------------------------
+// Spatial hash grid
+// ---------------------------------------------------
+void* dynsoa_grid_create() { return new dynsoa::SpatialGrid(); }
+void  dynsoa_grid_destroy(void* g) { delete static_cast<dynsoa::SpatialGrid*>(g); }
+
+void dynsoa_grid_build(void* g, dynsoa::ViewId v, dynsoa::ColumnId x, dynsoa::ColumnId y,
+                       dynsoa::ColumnId z, float cell_size) {
+  dynsoa::grid_build(*static_cast<dynsoa::SpatialGrid*>(g), v, x, y, z, cell_size);
+}
+
+int dynsoa_grid_query(const void* g, float x, float y, float z, float radius,
+                      dynsoa::GridRange* out, int max_out) {
+  return dynsoa::grid_query(*static_cast<const dynsoa::SpatialGrid*>(g), x, y, z, radius, out, max_out);
+}
+
+const uint32_t* dynsoa_grid_order(const void* g) {
+  return static_cast<const dynsoa::SpatialGrid*>(g)->order.data();
+}
+
 // ---------------------------------------------------
 // Frame / scheduler
 // ---------------------------------------------------
@@ -83,7 +170,36 @@ void dynsoa_run_kernel(const char* name,
   dynsoa::run_kernel(name, fn, v, *ctx);
 }
 
+void dynsoa_run_kernel_parallel(const char* name,
+                                void (*fn)(dynsoa::ViewId, const dynsoa::KernelCtx&, size_t, size_t),
+                                dynsoa::ViewId v,
+                                const dynsoa::KernelCtx* ctx) {
+  dynsoa::run_kernel_parallel(name, fn, v, *ctx);
+}
+
+void dynsoa_run_kernel_query(const char* name,
+                             void (*fn)(dynsoa::ViewId, const dynsoa::KernelCtx&, size_t, size_t),
+                             dynsoa::QueryId q,
+                             const dynsoa::KernelCtx* ctx) {
+  dynsoa::run_kernel_query(name, fn, q, *ctx);
+}
+void dynsoa_run_kernel_changed(const char* name,
+                               void (*fn)(dynsoa::ViewId, const dynsoa::KernelCtx&, size_t, size_t),
+                               dynsoa::ViewId v, const dynsoa::ColumnId* cols, int k, uint64_t since,
+                               const dynsoa::KernelCtx* ctx) {
+  dynsoa::run_kernel_changed(name, fn, v, cols, k, since, *ctx);
+}
+
+dynsoa::QueryId dynsoa_make_query(const char** comps, int k) { return dynsoa::make_query(comps, k); }
+int dynsoa_query_views(dynsoa::QueryId q, dynsoa::ViewId* out, int max_out) {
+  const auto views = dynsoa::query_views(q);
+  for (int i = 0; i < max_out && i < (int)views.size(); ++i) out[i] = views[(std::size_t)i];
+  return (int)views.size();
+}
+
 void dynsoa_end_frame() {
+  dynsoa::swap_column_buffers(); // before spawns, whose rows are only initialized in the front buffer
+  dynsoa::commands_flush(); // structural changes first, so the scheduler sees the final row counts
   dynsoa::scheduler_on_end_frame();
   dynsoa::end_frame();
 }
@@ -91,10 +207,18 @@ void dynsoa_end_frame() {
 // ---------------------------------------------------
 // Policy (always-trigger for demo visibility)
 // ---------------------------------------------------
-void dynsoa_set_policy(const char* /*json_or_empty*/) {
+void dynsoa_set_policy(const char* json_or_empty) {
   dynsoa::Policy P;
   // Simple "always true" trigger so we can observe actions & learning.
-  P.triggers.push_back({"mean_us >= 0", "RETILE_AOSOA", 128, 1.0});
+  // An "action" key picks the trigger's action, e.g. {"action": "AUTO"}.
+  std::string action = "RETILE_AOSOA";
+  const std::string js = json_or_empty ? json_or_empty : "";
+  auto pos = js.find("\"action\"");
+  if (pos != std::string::npos && (pos = js.find(':', pos)) != std::string::npos) {
+    auto b = js.find('"', pos), e = b == std::string::npos ? b : js.find('"', b + 1);
+    if (e != std::string::npos) action = js.substr(b + 1, e - b - 1);
+  }
+  P.triggers.push_back({"mean_us >= 0", action, action == "PARTITION_BY_MASK" ? 0 : 128, 1.0});
   P.cooloff_frames = 2;
   dynsoa::scheduler_set_policy(P);
 }
@@ -3,55 +3,499 @@
 #include "dynsoa/entity_store.h"
 #include "dynsoa/schema.h"
 #include "dynsoa/layout.h"
+#include "dynsoa/thread_pool.h"
+#include "dynsoa/memory.h"
 #include <vector>
 #include <string>
 #include <unordered_map>
 #include <cassert>
 #include <cstring>
 #include <cstdlib>
+#include <cstdio>
 #include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <atomic>
+#include <utility>
 
 namespace dynsoa {
 
 struct ColumnData {
-  std::vector<std::uint8_t> bytes;
-  std::size_t elem_size = sizeof(float); // default f32 for sample
+  std::string path;
+  ScalarType  type = ScalarType::F32;
+  std::size_t elem_size = sizeof(float);
+  std::size_t tile_off = 0; // byte offset of this column's lane block inside a tile
+  // Change stamp of each change block (see mark_changed); atomic so tasks of
+  // one parallel kernel may mark rows that share a block.
+  std::vector<std::atomic<std::uint64_t>> block_version;
+  // Back buffer of a double-buffered pair: only writes stamp it, so its
+  // stamps tell swap_column_buffers which blocks the frame produced.
+  bool back_buffer = false;
+  // Back buffers only, one bit per row: rows written since the last swap
+  // (set by concurrent mark_rows calls) and rows where this buffer lags the
+  // front, which the next swap must copy forward unless they were rewritten.
+  std::vector<std::atomic<std::uint64_t>> rows_written;
+  std::vector<std::uint64_t> rows_behind;
+  bool unmarked_warned = false;
 };
 
+static constexpr std::size_t kBlockAlign = kColumnAlign;
+
+// Base alignment of view storage buffers (set_column_alignment).
+static std::size_t g_column_align = kColumnAlign;
+
+static std::size_t align_up(std::size_t n, std::size_t a) { return (n + a - 1) / a * a; }
+
+// Thread-local scratch (matrix block pool). View storage instead goes
+// through storage_alloc and the memory policy (memory.h).
+static void* alloc_aligned(std::size_t n, std::size_t align) {
+#if defined(_WIN32)
+  return _aligned_malloc(n, align);
+#else
+  void* p = nullptr;
+  return posix_memalign(&p, align, n) == 0 ? p : nullptr;
+#endif
+}
+
+static void free_aligned(void* p) {
+#if defined(_WIN32)
+  _aligned_free(p);
+#else
+  std::free(p);
+#endif
+}
+
+// Fixed-size chunk of a chunked view: one tile, allocated on its own so
+// growth appends chunks instead of reallocating.
+struct ChunkFree { void operator()(std::uint8_t* p) const { storage_free(p); } };
+using ChunkPtr = std::unique_ptr<std::uint8_t, ChunkFree>;
+
+// Raw byte storage, aligned to g_column_align and sized in whole multiples of
+// it. Contents are left uninitialised so retiles don't pay for zeroing; new
+// rows and padding are cleared explicitly.
+struct Buffer {
+  ChunkPtr ptr;
+  std::size_t cap = 0;
+
+  std::uint8_t* data() const { return ptr.get(); }
+  // Grow to at least n bytes; never shrinks, so a reused buffer stops allocating.
+  void reserve(std::size_t n, bool keep_contents) {
+    if (n <= cap) return;
+    n = align_up(n, g_column_align);
+    ChunkPtr p((std::uint8_t*)storage_alloc(n, g_column_align));
+    if (!p) throw std::bad_alloc();
+    if (keep_contents && cap) std::memcpy(p.get(), ptr.get(), cap);
+    ptr.swap(p); cap = n;
+  }
+};
+
+// All columns of a view share one buffer made of tiles laid out as
+// [tile][component][lane]. SoA is the degenerate case of a single tile whose
+// lane count is the row capacity; AoSoA uses tile_rows = T. The Chunked
+// layout has the same tiles, but each in its own fixed-size allocation.
 struct ViewRec {
   ArchetypeId arch{};
   std::size_t len{};
-  std::unordered_map<std::string, ColumnData> columns;
+  std::vector<ColumnData> columns;                      // indexed by ColumnId
+  std::unordered_map<std::string, ColumnId> column_ids; // path -> ColumnId
+  Buffer data;
+  Buffer scratch;                    // relayout target, swapped with `data` and kept for the next retile
+  std::vector<ChunkPtr> chunks;      // Chunked layout: tile k lives in chunks[k] instead of `data`
+  std::vector<ChunkPtr> spare_chunks;
+  std::size_t chunk_bytes = 0;
+  std::vector<std::size_t> prev_off; // tile_off of each column before the last relayout
+  std::size_t row_bytes = 0;  // sum of elem_size over columns
+  std::size_t tile_rows = 0;  // lanes per tile
+  std::size_t tile_bytes = 0; // lane blocks of every column, each padded to kLaneAlign
+  std::size_t tile_count = 0;
   LayoutKind layout = LayoutKind::SoA;
   int aosoa_tile = 0;
+  // Sparse -> dense entity index. A handle names a slot; the slot records its
+  // current row and generation. slot_of_row is the inverse, so moving a row
+  // (swap-remove, reorder) fixes both sides in O(1).
+  std::vector<std::uint32_t> row_of_slot;
+  std::vector<std::uint32_t> gen_of_slot;
+  std::vector<std::uint32_t> slot_of_row;
+  std::vector<std::uint32_t> free_slots;
+  std::vector<RowPartition> partitions; // from the last transform_partition_by_mask, while rows are unchanged
+  ColumnId      partition_col = kInvalidColumn; // key and mask that produced partitions
+  std::uint32_t partition_mask = 0;
+  std::string   morton_key;       // component of the last transform_sort_morton, while rows are unchanged
+  std::uint64_t morton_epoch = 0; // change clock right after that sort
+  std::size_t change_rows = 0;          // rows per change block when block_version was last sized
+  std::vector<std::pair<ColumnId, ColumnId>> double_buffered; // (front, back)
 };
 
+static constexpr std::uint32_t kNoRow = 0xffffffffu;
+
+static EntityId make_entity(std::uint32_t gen, std::uint32_t slot) {
+  return ((EntityId)gen << 32) | slot;
+}
+
+// Row of a live handle, or kNoRow when the slot is free or reused.
+static std::uint32_t live_row(const ViewRec& V, EntityId e) {
+  const std::uint32_t slot = (std::uint32_t)e, gen = (std::uint32_t)(e >> 32);
+  if (slot >= V.gen_of_slot.size() || V.gen_of_slot[slot] != gen) return kNoRow;
+  return V.row_of_slot[slot];
+}
+
 std::vector<ViewRec> g_views;
 
-void* spawn(ArchetypeId arch, std::size_t count, void(*init_fn)(std::size_t, void*)) {
-  ViewRec v; v.arch = arch; v.len = count;
+static std::size_t capacity(const ViewRec& V) { return V.tile_rows * V.tile_count; }
 
-  auto makeF32Col = [&](const std::string& path){
-    ColumnData cd; cd.elem_size = sizeof(float);
-    cd.bytes.resize(count * cd.elem_size);
-    v.columns[path] = std::move(cd);
-  };
-  makeF32Col("Position.x"); makeF32Col("Position.y"); makeF32Col("Position.z");
-  makeF32Col("Velocity.vx"); makeF32Col("Velocity.vy"); makeF32Col("Velocity.vz");
+static std::uint8_t* tile_base(ViewRec& V, std::size_t k) {
+  return V.chunks.empty() ? V.data.data() + k * V.tile_bytes : V.chunks[k].get();
+}
 
-  if (init_fn) {
-    struct Row { float px,py,pz,vx,vy,vz; } row{};
-    for (std::size_t i=0;i<count;++i) { init_fn(i, (void*)&row); }
+// Home node of chunk k when chunked views are striped across NUMA nodes.
+static int chunk_node(std::size_t k) {
+  return numa_striping() ? (int)((k / kNumaStripeChunks) % (std::size_t)numa_node_count()) : -1;
+}
+
+// Chunk to become tile k. A reused spare is moved to k's node if striping.
+static ChunkPtr take_chunk(ViewRec& V, std::size_t k) {
+  const int node = chunk_node(k);
+  if (!V.spare_chunks.empty()) {
+    ChunkPtr c = std::move(V.spare_chunks.back());
+    V.spare_chunks.pop_back();
+    if (node >= 0) storage_place(c.get(), V.chunk_bytes, node);
+    return c;
+  }
+  auto* p = (std::uint8_t*)storage_alloc(V.chunk_bytes, kBlockAlign, node);
+  if (!p) throw std::bad_alloc();
+  return ChunkPtr(p);
+}
+
+// Old tile addresses, captured before storage is replaced.
+static std::vector<const std::uint8_t*> tile_table(ViewRec& V) {
+  std::vector<const std::uint8_t*> t(V.tile_count);
+  for (std::size_t k = 0; k < V.tile_count; ++k) t[k] = tile_base(V, k);
+  return t;
+}
+
+// Swap in fresh storage for the current tiling. The previous contents stay
+// readable (scratch or spare chunks) until the next call.
+static void replace_storage(ViewRec& V, bool chunked) {
+  std::vector<ChunkPtr> fresh;
+  if (chunked)
+    for (std::size_t k = 0; k < V.tile_count; ++k) fresh.push_back(take_chunk(V, k));
+  for (auto& c : V.chunks) V.spare_chunks.push_back(std::move(c));
+  V.chunks.swap(fresh);
+  if (!chunked) {
+    V.scratch.reserve(V.tile_bytes * V.tile_count, false);
+    std::swap(V.data, V.scratch);
+  }
+}
+
+static std::uint8_t* lane_ptr(ViewRec& V, const ColumnData& c, std::size_t row) {
+  const std::size_t k = row / V.tile_rows;
+  return tile_base(V, k) + c.tile_off + (row - k * V.tile_rows) * c.elem_size;
+}
+
+// Lane blocks start on this boundary so every column's lanes begin on a cache
+// line, whatever the tile row count and the widths of the columns before it.
+static constexpr std::size_t kLaneAlign = kColumnAlign;
+
+// Rows a kernel may run over without a tail: a whole tile when tiled, else
+// len rounded up to kPadRows (the view capacity is kept a multiple of it).
+static std::size_t padded_len(const ViewRec& V) {
+  if (V.tile_rows == 0) return 0;
+  const std::size_t unit = V.layout == LayoutKind::SoA ? kPadRows : V.tile_rows;
+  return std::min(align_up(V.len, unit), capacity(V));
+}
+
+// Zero the rows between len and padded_len, so tail-free kernels read zeros.
+// Rows there stay zero until len grows over them, so callers that know which
+// part may be dirty pass [from, to) to clear only that.
+static void clear_padding(ViewRec& V, std::size_t from = 0, std::size_t to = SIZE_MAX) {
+  const std::size_t end = std::min(padded_len(V), to);
+  for (const auto& c : V.columns)
+    for (std::size_t r = std::max(V.len, from); r < end;) {
+      const std::size_t n = std::min(end - r, V.tile_rows - r % V.tile_rows);
+      std::memset(lane_ptr(V, c, r), 0, n * c.elem_size);
+      r += n;
+    }
+}
+
+// ---------------------------------------------------
+// Change tracking
+// ---------------------------------------------------
+static std::atomic<std::uint64_t> g_change_clock{0};
+
+static std::size_t change_rows_for(const ViewRec& V) {
+  return V.layout == LayoutKind::SoA || V.tile_rows == 0 ? kChangeBlockRows : V.tile_rows;
+}
+
+static void fill_blocks(ColumnData& c, std::size_t blocks, std::uint64_t ver) {
+  std::vector<std::atomic<std::uint64_t>> bv(blocks);
+  for (auto& b : bv) b.store(ver, std::memory_order_relaxed);
+  c.block_version.swap(bv);
+}
+
+static void grow_blocks(std::vector<std::atomic<std::uint64_t>>& bv, std::size_t blocks) {
+  if (bv.size() >= blocks) return;
+  std::vector<std::atomic<std::uint64_t>> grown(blocks);
+  for (std::size_t k = 0; k < bv.size(); ++k) grown[k].store(bv[k].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  bv.swap(grown);
+}
+
+static std::size_t bit_words(std::size_t rows) { return (rows + 63) / 64; }
+
+// Bits [lo, hi) of a word, 0 <= lo < hi <= 64.
+static std::uint64_t bit_span(std::size_t lo, std::size_t hi) {
+  return (hi == 64 ? ~0ull : (1ull << hi) - 1) & ~((1ull << lo) - 1);
+}
+
+// Call fn(word, mask) for each word of a row bitmap covering [begin, end).
+template <class Fn>
+static void for_each_bit_span(std::size_t begin, std::size_t end, Fn&& fn) {
+  for (std::size_t w = begin / 64; begin < end; ++w) {
+    const std::size_t hi = std::min(end, (w + 1) * 64);
+    fn(w, bit_span(begin - w * 64, hi - w * 64));
+    begin = hi;
+  }
+}
+
+// Rows [begin, end) of a back buffer were restructured: whatever the frame
+// wrote there may belong to another row now, so they lag the front again.
+static void stamp_back_rows(ColumnData& c, std::size_t rows, std::size_t begin, std::size_t end) {
+  grow_blocks(c.rows_written, bit_words(rows));
+  if (c.rows_behind.size() < bit_words(rows)) c.rows_behind.resize(bit_words(rows), 0);
+  for_each_bit_span(begin, end, [&](std::size_t w, std::uint64_t m) {
+    c.rows_behind[w] |= m;
+    c.rows_written[w].fetch_and(~m, std::memory_order_relaxed);
+  });
+}
+
+// Structural stamp, after rows [begin, end) were added, moved or removed (or
+// the tiling or column set changed): sizes every column's blocks for the view
+// and stamps the range in every front column. When the block size changed (a
+// retile) every block is stamped, since rows may now sit anywhere. Back
+// buffers only record writes. Runs on the thread restructuring the view.
+static void stamp_rows(ViewRec& V, std::size_t begin, std::size_t end) {
+  const std::size_t B = change_rows_for(V);
+  const std::size_t rows = std::max(end, V.len);
+  const std::size_t blocks = (rows + B - 1) / B;
+  const std::uint64_t ver = g_change_clock.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (B != V.change_rows) {
+    V.change_rows = B;
+    for (auto& c : V.columns) {
+      fill_blocks(c, blocks, c.back_buffer ? 0 : ver);
+      if (c.back_buffer) stamp_back_rows(c, rows, 0, V.len);
+    }
+    return;
+  }
+  for (auto& c : V.columns) {
+    grow_blocks(c.block_version, blocks);
+    if (c.back_buffer) stamp_back_rows(c, rows, begin, end);
+    if (c.back_buffer || begin >= end) continue;
+    for (std::size_t k = begin / B; k <= (end - 1) / B; ++k) c.block_version[k].store(ver, std::memory_order_relaxed);
+  }
+}
+
+// A write to rows [begin, end) of column c. Only relaxed stores into blocks
+// the last structural stamp sized, so concurrent kernel tasks may mark.
+static void mark_rows(ViewRec& V, std::size_t begin, std::size_t end, ColumnId c) {
+  const std::size_t B = V.change_rows;
+  if (c < 0 || (std::size_t)c >= V.columns.size() || B == 0 || begin >= end) return;
+  assert(B == change_rows_for(V));
+  auto& col = V.columns[(std::size_t)c];
+  auto& bv = col.block_version;
+  const std::uint64_t ver = g_change_clock.fetch_add(1, std::memory_order_relaxed) + 1;
+  for (std::size_t k = begin / B; k <= (end - 1) / B && k < bv.size(); ++k) bv[k].store(ver, std::memory_order_relaxed);
+  if (!col.back_buffer) return;
+  for_each_bit_span(begin, std::min(end, col.rows_written.size() * 64), [&](std::size_t w, std::uint64_t m) {
+    col.rows_written[w].fetch_or(m, std::memory_order_relaxed);
+  });
+}
+
+static void stamp_all(ViewRec& V) { stamp_rows(V, 0, V.len); }
+
+static void set_tiling(ViewRec& V, std::size_t tile_rows, std::size_t tile_count) {
+  std::size_t off = 0;
+  for (auto& c : V.columns) { c.tile_off = off; off = align_up(off + tile_rows * c.elem_size, kLaneAlign); }
+  V.tile_rows = tile_rows; V.tile_bytes = off; V.tile_count = tile_count;
+}
+
+// Move every live row from the current tiling into a new one. Rows are copied
+// in runs bounded by both the old and the new tile edges, so each run is a
+// single memcpy per column. The target is the view's persistent scratch
+// buffer (or spare chunks); after the swap the old storage becomes scratch
+// for the next retile, so steady-state retiles do not touch the allocator.
+// The last `added` columns are new and have no old contents to copy.
+static void relayout(ViewRec& V, std::size_t tile_rows, std::size_t tile_count, bool chunked = false,
+                     std::size_t added = 0) {
+  const std::size_t old_rows = V.tile_rows;
+  const std::vector<const std::uint8_t*> old_tiles = tile_table(V);
+  V.prev_off.resize(V.columns.size());
+  for (std::size_t c = 0; c < V.columns.size(); ++c) V.prev_off[c] = V.columns[c].tile_off;
+
+  set_tiling(V, tile_rows, tile_count);
+  replace_storage(V, chunked);
+
+  for (std::size_t c = 0; c + added < V.columns.size() && old_rows != 0; ++c) {
+    const std::size_t e = V.columns[c].elem_size;
+    std::size_t r = 0;
+    while (r < V.len) {
+      const std::size_t k = r / old_rows, i = r - k * old_rows;
+      std::size_t n = std::min(old_rows - i, V.tile_rows - r % V.tile_rows);
+      n = std::min(n, V.len - r);
+      std::memcpy(lane_ptr(V, V.columns[c], r), old_tiles[k] + V.prev_off[c] + i * e, n * e);
+      r += n;
+    }
+  }
+  clear_padding(V);
+}
+
+// Build one typed column per component field of the view's archetype.
+static void build_columns(ViewRec& V) {
+  const ArchetypeDesc* desc = find_archetype(V.arch);
+  if (!desc) return;
+  for (const auto& cname : desc->components) {
+    const ComponentDesc* comp = find_component(cname);
+    if (!comp) continue;
+    for (const auto& f : comp->fields) {
+      ColumnData cd; cd.type = f.type; cd.elem_size = scalar_size(f.type);
+      cd.path = column_path(comp->name, f.name);
+      if (V.column_ids.count(cd.path)) continue;
+      V.column_ids[cd.path] = (ColumnId)V.columns.size();
+      V.row_bytes += cd.elem_size;
+      V.columns.push_back(std::move(cd));
+    }
+  }
+}
+
+static ViewRec& view_for_arch(ArchetypeId arch) {
+  for (auto& V : g_views) if (V.arch == arch) return V;
+  ViewRec V; V.arch = arch;
+  build_columns(V);
+  g_views.push_back(std::move(V));
+  return g_views.back();
+}
+
+// Grow storage to hold `rows`. Chunked appends chunks without touching
+// existing rows; AoSoA appends whole tiles; SoA re-lays the single tile out
+// with geometric headroom.
+static void reserve_rows(ViewRec& V, std::size_t rows) {
+  if (rows <= capacity(V)) return;
+  if (V.layout == LayoutKind::Chunked) {
+    while (V.chunks.size() * V.tile_rows < rows) V.chunks.push_back(take_chunk(V, V.chunks.size()));
+    V.tile_count = V.chunks.size();
+    return;
+  }
+  if (V.layout == LayoutKind::AoSoA) {
+    V.tile_count = (rows + V.tile_rows - 1) / V.tile_rows;
+    V.data.reserve(std::max(V.tile_bytes * V.tile_count, V.data.cap + V.data.cap / 2), true);
+    V.tile_count = std::max(V.tile_count, V.data.cap / std::max<std::size_t>(V.tile_bytes, 1));
+    return;
+  }
+  relayout(V, align_up(std::max(rows, capacity(V) + capacity(V) / 2), kPadRows), 1);
+}
+
+// Visit rows [row, row+n) of column `c` as contiguous tile-bounded runs.
+template <class Fn>
+static void for_each_run(ViewRec& V, const ColumnData& c, std::size_t row, std::size_t n, Fn&& fn) {
+  while (n > 0) {
+    std::size_t run = std::min(n, V.tile_rows - row % V.tile_rows);
+    fn(lane_ptr(V, c, row), run);
+    row += run; n -= run;
   }
+}
 
-  g_views.push_back(std::move(v));
+// Append `count` rows with fresh handles; returns the first new row. With
+// zero=false the caller owns clearing the new rows.
+static std::size_t append_rows(ViewRec& V, std::size_t count, bool zero = true) {
+  const std::size_t first = V.len;
+  const std::size_t old_pad = padded_len(V);
+  V.partitions.clear();
+  V.morton_key.clear();
+  reserve_rows(V, V.len + count);
+  V.len += count;
+  V.slot_of_row.resize(V.len);
+  for (std::size_t i = first; i < V.len; ++i) {
+    std::uint32_t slot;
+    if (!V.free_slots.empty()) { slot = V.free_slots.back(); V.free_slots.pop_back(); }
+    else {
+      slot = (std::uint32_t)V.row_of_slot.size();
+      V.row_of_slot.push_back(kNoRow);
+      V.gen_of_slot.push_back(1);
+    }
+    V.row_of_slot[slot] = (std::uint32_t)i;
+    V.slot_of_row[i] = slot;
+  }
+  if (zero)
+    for (auto& c : V.columns)
+      for_each_run(V, c, first, count, [&](std::uint8_t* p, std::size_t n){ std::memset(p, 0, n * c.elem_size); });
+  clear_padding(V, old_pad); // padding below old_pad is still zero; only growth exposes new rows
+  stamp_rows(V, first, V.len);
+  return first;
+}
+
+void* spawn(ArchetypeId arch, std::size_t count, void(*init_fn)(std::size_t, void*)) {
+  ViewRec& V = view_for_arch(arch);
+  const std::size_t first = append_rows(V, count);
+
+  if (init_fn) {
+    std::vector<std::uint8_t> row(std::max<std::size_t>(V.row_bytes, 1));
+    for (std::size_t i=first;i<V.len;++i) {
+      std::memset(row.data(), 0, row.size());
+      init_fn(i, (void*)row.data());
+      const std::uint8_t* src = row.data();
+      for (const auto& c : V.columns) { std::memcpy(lane_ptr(V, c, i), src, c.elem_size); src += c.elem_size; }
+    }
+  }
   return nullptr;
 }
 
+namespace {
+
+struct SpawnJob {
+  ViewRec*    V;
+  ViewId      view;
+  std::size_t first, end;
+  SpawnInitFn fn;
+  void*       user;
+  std::vector<std::size_t> starts; // first row of each batch
+};
+
+void spawn_batch(void* arg, std::size_t t, int) {
+  SpawnJob& J = *static_cast<SpawnJob*>(arg);
+  ViewRec& V = *J.V;
+  const std::size_t r = J.starts[t];
+  const std::size_t n = (t + 1 < J.starts.size() ? J.starts[t + 1] : J.end) - r;
+  std::vector<void*> ptrs(V.columns.size());
+  for (std::size_t c = 0; c < V.columns.size(); ++c) {
+    std::uint8_t* p = lane_ptr(V, V.columns[c], r);
+    std::memset(p, 0, n * V.columns[c].elem_size);
+    ptrs[c] = p;
+  }
+  if (!J.fn) return;
+  const ColumnSet cs{J.view, r, n, ptrs.size(), ptrs.data()};
+  J.fn(r, n, &cs, J.user);
+}
+
+} // namespace
+
+std::size_t spawn_bulk(ArchetypeId arch, std::size_t count, SpawnInitFn init_fn, void* user) {
+  const ViewId view = make_view(arch);
+  ViewRec& V = g_views[(std::size_t)view - 1];
+  const std::size_t first = append_rows(V, count, false);
+
+  SpawnJob J{&V, view, first, V.len, init_fn, user, {}};
+  for (std::size_t r = first; r < J.end;) {
+    J.starts.push_back(r);
+    r += std::min({J.end - r, V.tile_rows - r % V.tile_rows, kSpawnBatchRows});
+  }
+  if (count >= kParallelSpawnRows) pool_run(J.starts.size(), spawn_batch, &J);
+  else for (std::size_t t = 0; t < J.starts.size(); ++t) spawn_batch(&J, t, 0);
+  return first;
+}
+
 ViewId make_view(ArchetypeId arch) {
   for (std::size_t i=0;i<g_views.size();++i)
     if (g_views[i].arch == arch) return static_cast<ViewId>(i+1);
-  g_views.push_back(ViewRec{arch,0,{},LayoutKind::SoA,0});
+  view_for_arch(arch);
   return static_cast<ViewId>(g_views.size());
 }
 
@@ -61,98 +505,776 @@ size_t view_len(ViewId v) {
 }
 
 void* column(ViewId v, const char* path) {
-  auto idx = static_cast<std::size_t>(v-1);
-  auto it = g_views[idx].columns.find(path);
-  if (it == g_views[idx].columns.end()) return nullptr;
-  return (void*)it->second.bytes.data();
+  return column_ptr(v, column_id(v, path));
+}
+
+ColumnId column_id(ViewId v, const char* path) {
+  if (!path) return kInvalidColumn;
+  auto& V = g_views[(std::size_t)v-1];
+  auto it = V.column_ids.find(path);
+  return it == V.column_ids.end() ? kInvalidColumn : it->second;
 }
 
-MatrixBlock acquire_matrix_block(ViewId v, const char** comps, int K, int B, std::size_t offset) {
+void* column_ptr(ViewId v, ColumnId c) {
+  return column_tile(v, c, 0);
+}
+
+bool column_has_type(ViewId v, ColumnId c, ScalarType t) {
+  const auto& V = g_views[(std::size_t)v-1];
+  return c >= 0 && (std::size_t)c < V.columns.size() && V.columns[(std::size_t)c].type == t;
+}
+
+std::size_t view_tile_rows(ViewId v) {
+  return g_views[(std::size_t)v-1].tile_rows;
+}
+
+void* column_tile(ViewId v, ColumnId c, std::size_t tile) {
+  auto& V = g_views[(std::size_t)v-1];
+  if (c < 0 || (std::size_t)c >= V.columns.size() || tile >= V.tile_count) return nullptr;
+  return tile_base(V, tile) + V.columns[(std::size_t)c].tile_off;
+}
+
+// Copy rows [row, row+n) of column `c` between the view and a dense array.
+static void copy_rows(ViewRec& V, const ColumnData& c, std::size_t row, std::size_t n,
+                      std::uint8_t* dense, bool to_view) {
+  for_each_run(V, c, row, n, [&](std::uint8_t* p, std::size_t run){
+    if (to_view) std::memcpy(p, dense, run * c.elem_size);
+    else         std::memcpy(dense, p, run * c.elem_size);
+    dense += run * c.elem_size;
+  });
+}
+
+// ---------------------------------------------------
+// Matrix blocks
+// ---------------------------------------------------
+// Pooled block buffers carry a header in front of the float data:
+// [BlockHeader][ColumnId src[cols]] padded to kBlockAlign, then the data.
+// The source handles let release scatter into exactly the acquired columns.
+struct alignas(kBlockAlign) BlockHeader {
+  std::uint64_t key; // (rows << 32) | cols
+  ViewId        view;
+};
+
+static std::size_t block_header_bytes(int K) {
+  return align_up(sizeof(BlockHeader) + sizeof(ColumnId) * (std::size_t)K, kBlockAlign);
+}
+static ColumnId* block_sources(BlockHeader* h) { return (ColumnId*)(h + 1); }
+
+// Per-thread free lists keyed by (rows, cols); acquire/release never lock.
+struct BlockPool {
+  static constexpr std::size_t kMaxFreePerKey = 16;
+  std::unordered_map<std::uint64_t, std::vector<BlockHeader*>> free;
+  ~BlockPool() { for (auto& kv : free) for (auto* h : kv.second) free_aligned(h); }
+};
+static thread_local BlockPool t_block_pool;
+
+static BlockHeader* pool_acquire(int B, int K) {
+  const std::uint64_t key = ((std::uint64_t)(std::uint32_t)B << 32) | (std::uint32_t)K;
+  auto& list = t_block_pool.free[key];
+  BlockHeader* h = nullptr;
+  if (!list.empty()) { h = list.back(); list.pop_back(); }
+  else {
+    h = (BlockHeader*)alloc_aligned(block_header_bytes(K) + sizeof(float) * (std::size_t)B * (std::size_t)K, kBlockAlign);
+    if (!h) return nullptr;
+    h->key = key;
+  }
+  return h;
+}
+
+static void pool_release(BlockHeader* h) {
+  auto& list = t_block_pool.free[h->key];
+  if (list.size() < BlockPool::kMaxFreePerKey) list.push_back(h);
+  else free_aligned(h);
+}
+
+// A block can alias the view when all rows sit in one tile and the requested
+// F32 columns are adjacent, equally spaced lane blocks (true for consecutive
+// F32 columns in both SoA and AoSoA).
+static bool try_zero_copy(ViewRec& V, const ColumnId* ids, int K, int B, std::size_t offset, MatrixBlock& mb) {
+  if (K <= 0 || B <= 0 || V.tile_rows == 0 || offset + (std::size_t)B > V.len) return false;
+  if (!V.chunks.empty()) return false;
+  if (offset / V.tile_rows != (offset + (std::size_t)B - 1) / V.tile_rows) return false;
+  std::size_t stride = 0;
+  for (int j=0; j<K; ++j) {
+    if (ids[j] == kInvalidColumn || V.columns[(std::size_t)ids[j]].type != ScalarType::F32) return false;
+    if (j == 0) continue;
+    const std::size_t a = V.columns[(std::size_t)ids[j-1]].tile_off, b = V.columns[(std::size_t)ids[j]].tile_off;
+    if (b <= a || (j > 1 && b - a != stride)) return false;
+    stride = b - a;
+  }
+  if (K > 1 && stride % sizeof(float) != 0) return false;
+  mb.data = (float*)lane_ptr(V, V.columns[(std::size_t)ids[0]], offset);
+  mb.leading_dim = K > 1 ? (int)(stride / sizeof(float)) : B;
+  mb.flags |= kMatrixBlockZeroCopy;
+  return true;
+}
+
+MatrixBlock acquire_matrix_block(ViewId v, const char** comps, int K, int B, std::size_t offset, unsigned flags) {
   auto& V = g_views[(std::size_t)v-1];
   MatrixBlock mb; mb.rows = B; mb.cols = K; mb.leading_dim = B; mb.offset = offset;
   mb.bytes = sizeof(float) * (std::size_t)B * (std::size_t)K;
-  mb.data  = (float*)std::malloc(mb.bytes);
+  if (K <= 0 || B <= 0) return mb;
+
+  std::vector<ColumnId> ids((std::size_t)K);
+  for (int j=0; j<K; ++j) ids[(std::size_t)j] = column_id(v, comps[j]);
+  if ((flags & kMatrixBlockZeroCopy) && try_zero_copy(V, ids.data(), K, B, offset, mb)) {
+    // Header only (no rows): remembers the aliased columns for change stamps.
+    BlockHeader* h = pool_acquire(0, K);
+    if (!h) return mb;
+    h->view = v;
+    for (int j=0; j<K; ++j) block_sources(h)[j] = ids[(std::size_t)j];
+    mb.header = h;
+    return mb;
+  }
+
+  BlockHeader* h = pool_acquire(B, K);
+  if (!h) return mb;
+  h->view = v;
+  mb.header = h;
+  mb.data = (float*)((std::uint8_t*)h + block_header_bytes(K));
+  const std::size_t n = offset < V.len ? std::min<std::size_t>(B, V.len - offset) : 0;
   for (int j=0; j<K; ++j) {
-    auto it = V.columns.find(comps[j]);
-    if (it == V.columns.end()) continue;
-    float* src = (float*)it->second.bytes.data();
-    for (int i=0; i<B; ++i) {
-      std::size_t idx = offset + (std::size_t)i;
-      if (idx >= V.len) break;
-      mb.data[j*B + i] = src[idx];
+    float* dst = mb.data + (std::size_t)j*B;
+    ColumnId c = ids[(std::size_t)j];
+    if (c != kInvalidColumn && V.columns[(std::size_t)c].type != ScalarType::F32) c = kInvalidColumn;
+    block_sources(h)[j] = c;
+    if (c == kInvalidColumn) {
+      std::memset(dst, 0, sizeof(float) * (std::size_t)B);
+      continue;
     }
+    copy_rows(V, V.columns[(std::size_t)c], offset, n, (std::uint8_t*)dst, false);
+    if (n < (std::size_t)B) std::memset(dst + n, 0, sizeof(float) * ((std::size_t)B - n));
   }
   return mb;
 }
 
 void release_matrix_block(ViewId v, MatrixBlock* mb, bool write_back) {
   if (!mb) return;
-  if (write_back && mb->data) {
-    auto& V = g_views[(std::size_t)v-1];
-    int K = mb->cols;
-    int B = mb->rows;
-    int j = 0;
-    for (auto& kv : V.columns) {
-      if (j >= K) break;
-      float* dst = (float*)kv.second.bytes.data();
-      for (int i=0; i<B; ++i) {
-        std::size_t idx = mb->offset + (std::size_t)i;
-        if (idx >= V.len) break;
-        dst[idx] = mb->data[j*B + i];
-      }
-      ++j;
+  auto& V = g_views[(std::size_t)v-1];
+  BlockHeader* h = (BlockHeader*)mb->header;
+  if (!h) { *mb = {}; return; }
+  assert(h->view == v);
+  const std::size_t n = mb->offset < V.len ? std::min((std::size_t)mb->rows, V.len - mb->offset) : 0;
+  if (mb->flags & kMatrixBlockZeroCopy) {
+    // Writes already landed in place (decided by the recorded flag: a retile
+    // since acquire may have moved the aliased storage); only stamp them.
+    if (write_back)
+      for (int j=0; j<mb->cols; ++j) mark_rows(V, mb->offset, mb->offset + n, block_sources(h)[j]);
+  } else if (write_back) {
+    // Scatter each block column back to the column it was gathered from, one
+    // memcpy per tile-bounded run; the partial tail stops at view_len.
+    const int K = mb->cols;
+    const std::size_t B = (std::size_t)mb->rows;
+    for (int j=0; j<K; ++j) {
+      ColumnId c = block_sources(h)[j];
+      if (c == kInvalidColumn) continue;
+      copy_rows(V, V.columns[(std::size_t)c], mb->offset, n, (std::uint8_t*)(mb->data + (std::size_t)j*B), true);
+      mark_rows(V, mb->offset, mb->offset + n, c);
     }
   }
-  if (mb->data) std::free(mb->data);
+  pool_release(h);
   *mb = {};
 }
 
 
-std::size_t bytes_to_move(ViewId v) {
+// ---------------------------------------------------
+// Row reordering
+// ---------------------------------------------------
+template <class T>
+static void gather_lanes(ViewRec& V, const ColumnData& c, const std::vector<const std::uint8_t*>& src,
+                         const std::vector<std::uint32_t>& perm) {
+  const std::size_t T_rows = V.tile_rows;
+  for (std::size_t r = 0; r < V.len; ++r) {
+    const std::size_t o = perm[r], k = o / T_rows;
+    const T* from = (const T*)(src[k] + c.tile_off) + (o - k * T_rows);
+    *(T*)lane_ptr(V, c, r) = *from;
+  }
+}
+
+// Apply perm (new row -> old row) to every column, keeping the tiling. The
+// old contents stay behind in scratch, as with relayout.
+static void permute_rows(ViewRec& V, const std::vector<std::uint32_t>& perm) {
+  const std::vector<const std::uint8_t*> src = tile_table(V);
+  replace_storage(V, !V.chunks.empty());
+  for (const auto& c : V.columns) {
+    switch (c.elem_size) {
+      case 4: gather_lanes<std::uint32_t>(V, c, src, perm); break;
+      case 8: gather_lanes<std::uint64_t>(V, c, src, perm); break;
+      default: break;
+    }
+  }
+
+  std::vector<std::uint32_t> slots(V.len);
+  for (std::size_t r = 0; r < V.len; ++r) slots[r] = V.slot_of_row[perm[r]];
+  V.slot_of_row.swap(slots);
+  for (std::size_t r = 0; r < V.len; ++r) V.row_of_slot[V.slot_of_row[r]] = (std::uint32_t)r;
+  V.partitions.clear();
+  V.morton_key.clear();
+  clear_padding(V);
+  stamp_all(V);
+}
+
+// Numeric columns of `component`, in field order, used as sort key axes.
+static std::vector<ColumnId> key_columns(const ViewRec& V, const char* component) {
+  std::vector<ColumnId> ids;
+  if (!component) return ids;
+  const std::string prefix = std::string(component) + ".";
+  for (std::size_t c = 0; c < V.columns.size() && ids.size() < 3; ++c)
+    if (V.columns[c].path.compare(0, prefix.size(), prefix) == 0 &&
+        (V.columns[c].type == ScalarType::F32 || V.columns[c].type == ScalarType::F64))
+      ids.push_back((ColumnId)c);
+  return ids;
+}
+
+static double key_value(ViewRec& V, const ColumnData& c, std::size_t row) {
+  const std::uint8_t* p = lane_ptr(V, c, row);
+  return c.type == ScalarType::F64 ? *(const double*)p : (double)*(const float*)p;
+}
+
+// Spread the low 21 bits of x so they occupy every third bit.
+static std::uint64_t spread3(std::uint64_t x) {
+  x &= 0x1fffff;
+  x = (x | x << 32) & 0x1f00000000ffffULL;
+  x = (x | x << 16) & 0x1f0000ff0000ffULL;
+  x = (x | x << 8)  & 0x100f00f00f00f00fULL;
+  x = (x | x << 4)  & 0x10c30c30c30c30c3ULL;
+  x = (x | x << 2)  & 0x1249249249249249ULL;
+  return x;
+}
+
+int morton_key_dims(ViewId v, const char* component) {
+  return (int)key_columns(g_views[(std::size_t)v-1], component).size();
+}
+
+bool transform_sort_morton(ViewId v, const char* component) {
   auto& V = g_views[(std::size_t)v-1];
-  std::size_t sum = 0;
-  for (auto& kv : V.columns) sum += kv.second.bytes.size();
-  return sum;
+  const std::vector<ColumnId> axes = key_columns(V, component);
+  if (axes.empty() || V.len < 2) return false;
+
+  // Quantise each axis over the view's bounding box to 21 bits.
+  double lo[3] = {0, 0, 0}, scale[3] = {0, 0, 0};
+  for (std::size_t a = 0; a < axes.size(); ++a) {
+    const ColumnData& c = V.columns[(std::size_t)axes[a]];
+    double mn = key_value(V, c, 0), mx = mn;
+    for (std::size_t r = 1; r < V.len; ++r) {
+      const double x = key_value(V, c, r);
+      mn = std::min(mn, x); mx = std::max(mx, x);
+    }
+    lo[a] = mn;
+    scale[a] = mx > mn ? (double)0x1fffff / (mx - mn) : 0.0;
+  }
+
+  std::vector<std::pair<std::uint64_t, std::uint32_t>> keyed(V.len);
+  for (std::size_t r = 0; r < V.len; ++r) {
+    std::uint64_t key = 0;
+    for (std::size_t a = 0; a < axes.size(); ++a) {
+      const double q = (key_value(V, V.columns[(std::size_t)axes[a]], r) - lo[a]) * scale[a];
+      key |= spread3((std::uint64_t)std::max(0.0, q)) << a;
+    }
+    keyed[r] = {key, (std::uint32_t)r};
+  }
+  std::sort(keyed.begin(), keyed.end());
+
+  std::vector<std::uint32_t> perm(V.len);
+  for (std::size_t r = 0; r < V.len; ++r) perm[r] = keyed[r].second;
+  permute_rows(V, perm);
+  V.morton_key = component;
+  V.morton_epoch = g_change_clock.load(std::memory_order_relaxed);
+  return true;
 }
 
-LayoutKind entity_current_layout(ViewId v) {
+bool view_morton_sorted(ViewId v, const char* component) {
+  const auto& V = g_views[(std::size_t)v-1];
+  if (V.morton_key.empty() || !component || V.morton_key != component) return false;
+  for (ColumnId c : key_columns(V, component))
+    for (const auto& b : V.columns[(std::size_t)c].block_version)
+      if (b.load(std::memory_order_relaxed) > V.morton_epoch) return false;
+  return true;
+}
+
+static const ColumnData* partition_key(const ViewRec& V, const char* path) {
+  if (!path) return nullptr;
+  auto it = V.column_ids.find(path);
+  if (it == V.column_ids.end()) return nullptr;
+  const ColumnData& c = V.columns[(std::size_t)it->second];
+  return c.type == ScalarType::U32 ? &c : nullptr;
+}
+
+bool partition_key_valid(ViewId v, const char* path) {
+  return partition_key(g_views[(std::size_t)v-1], path) != nullptr;
+}
+
+bool transform_partition_by_mask(ViewId v, const char* path, std::uint32_t mask) {
   auto& V = g_views[(std::size_t)v-1];
-  return V.layout;
+  const ColumnData* c = partition_key(V, path);
+  if (!c) return false;
+  if (mask == 0) mask = ~0u;
+
+  // (key, row) pairs sort stably by key; skip the row moves when the view is
+  // already grouped (e.g. re-partitioning after nothing changed).
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> keyed(V.len);
+  bool sorted = true;
+  for (std::size_t r = 0; r < V.len; ++r) {
+    keyed[r] = {*(const std::uint32_t*)lane_ptr(V, *c, r) & mask, (std::uint32_t)r};
+    if (r > 0 && keyed[r].first < keyed[r - 1].first) sorted = false;
+  }
+  if (!sorted) {
+    std::sort(keyed.begin(), keyed.end());
+    std::vector<std::uint32_t> perm(V.len);
+    for (std::size_t r = 0; r < V.len; ++r) perm[r] = keyed[r].second;
+    permute_rows(V, perm);
+  }
+
+  V.partitions.clear();
+  for (std::size_t r = 0; r < V.len; ++r) {
+    if (r == 0 || keyed[r].first != keyed[r - 1].first)
+      V.partitions.push_back({keyed[r].first, (std::uint32_t)r, (std::uint32_t)r});
+    V.partitions.back().end = (std::uint32_t)(r + 1);
+  }
+  V.partition_col = V.column_ids.find(path)->second;
+  V.partition_mask = mask;
+  return true;
+}
+
+bool view_partitioned_by(ViewId v, const char* path, std::uint32_t mask) {
+  const auto& V = g_views[(std::size_t)v-1];
+  if (V.partitions.empty() || !partition_key(V, path)) return false;
+  return V.partition_col == V.column_ids.find(path)->second && V.partition_mask == (mask ? mask : ~0u);
 }
 
-void transform_soa_to_aosoa(ViewId v, int T) {
+int view_partitions(ViewId v, RowPartition* out, int max_out) {
+  const auto& P = g_views[(std::size_t)v-1].partitions;
+  for (int i = 0; out && i < max_out && (std::size_t)i < P.size(); ++i) out[i] = P[(std::size_t)i];
+  return (int)P.size();
+}
+
+// ---------------------------------------------------
+// Entity handles
+// ---------------------------------------------------
+std::size_t entity_row(ViewId v, EntityId e) {
+  const std::uint32_t r = live_row(g_views[(std::size_t)v-1], e);
+  return r == kNoRow ? (std::size_t)-1 : r;
+}
+
+EntityId row_entity(ViewId v, std::size_t row) {
   auto& V = g_views[(std::size_t)v-1];
-  const std::size_t N = V.len;
-  const std::size_t tile_cnt = (N + T - 1) / T;
+  if (row >= V.len) return kInvalidEntity;
+  const std::uint32_t slot = V.slot_of_row[row];
+  return make_entity(V.gen_of_slot[slot], slot);
+}
+
+bool entity_alive(ViewId v, EntityId e) {
+  return live_row(g_views[(std::size_t)v-1], e) != kNoRow;
+}
+
+// Move rows [src, src+n) of column `c` down to dst (dst <= src), in runs
+// bounded by both tiles' edges.
+static void move_rows(ViewRec& V, const ColumnData& c, std::size_t dst, std::size_t src, std::size_t n) {
+  while (n > 0) {
+    std::size_t run = std::min(n, V.tile_rows - dst % V.tile_rows);
+    run = std::min(run, V.tile_rows - src % V.tile_rows);
+    std::memmove(lane_ptr(V, c, dst), lane_ptr(V, c, src), run * c.elem_size);
+    dst += run; src += run; n -= run;
+  }
+}
 
-  for (auto& kv : V.columns) {
-    auto& col = kv.second;
-    const std::size_t elem = col.elem_size;
-    const std::uint8_t* src = col.bytes.data();
-    std::vector<std::uint8_t> dst(col.bytes.size());
+// Removes the given rows (sorted, unique); their slots are already retired.
+// A handful of rows far from the end are swap-removed, touching only those
+// rows; otherwise the survivors after the first hole slide down in one
+// ordered memmove pass per column, which also keeps any spatial sort intact.
+static void remove_rows(ViewRec& V, const std::vector<std::uint32_t>& dead) {
+  const std::size_t k = dead.size();
+  const std::size_t old_len = V.len; // padding past it is still zero
+  V.partitions.clear();
+  V.morton_key.clear();
+  if (k * 8 < V.len - dead[0]) {
+    for (std::size_t i = k; i-- > 0;) {
+      const std::uint32_t r = dead[i], last = (std::uint32_t)(V.len - 1);
+      if (r != last) {
+        stamp_rows(V, r, r + 1);
+        for (const auto& c : V.columns) std::memcpy(lane_ptr(V, c, r), lane_ptr(V, c, last), c.elem_size);
+        V.slot_of_row[r] = V.slot_of_row[last];
+        V.row_of_slot[V.slot_of_row[r]] = r;
+      }
+      V.slot_of_row.pop_back();
+      --V.len;
+    }
+    clear_padding(V, 0, old_len);
+    return;
+  }
 
-    for (std::size_t k = 0; k < tile_cnt; ++k) {
-      std::size_t b = k * T;
-      std::size_t e = std::min(N, b + (std::size_t)T);
-      std::size_t n = e - b;
-      std::memcpy(dst.data() + b*elem, src + b*elem, n*elem);
+  stamp_rows(V, dead[0], V.len);
+  for (const auto& c : V.columns) {
+    std::size_t dst = dead[0];
+    for (std::size_t i = 0; i < k; ++i) {
+      const std::size_t from = dead[i] + 1, to = (i + 1 < k) ? dead[i + 1] : V.len;
+      move_rows(V, c, dst, from, to - from);
+      dst += to - from;
     }
-    col.bytes.swap(dst);
   }
+  std::size_t dst = dead[0];
+  for (std::size_t i = 0; i < k; ++i) {
+    const std::size_t to = (i + 1 < k) ? dead[i + 1] : V.len;
+    for (std::size_t r = dead[i] + 1; r < to; ++r, ++dst) {
+      V.slot_of_row[dst] = V.slot_of_row[r];
+      V.row_of_slot[V.slot_of_row[dst]] = (std::uint32_t)dst;
+    }
+  }
+  V.len -= k;
+  V.slot_of_row.resize(V.len);
+  clear_padding(V, 0, old_len);
+}
+
+std::size_t destroy_entities(ViewId v, const EntityId* es, std::size_t n) {
+  auto& V = g_views[(std::size_t)v-1];
+  std::vector<std::uint32_t> dead;
+  dead.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const std::uint32_t r = live_row(V, es[i]);
+    if (r == kNoRow) continue; // stale, or a duplicate already retired below
+    const std::uint32_t slot = (std::uint32_t)es[i];
+    V.row_of_slot[slot] = kNoRow;
+    if (++V.gen_of_slot[slot] == 0) V.gen_of_slot[slot] = 1; // 0 is kInvalidEntity's generation
+    V.free_slots.push_back(slot);
+    dead.push_back(r);
+  }
+  if (dead.empty()) return 0;
+  std::sort(dead.begin(), dead.end());
+  remove_rows(V, dead);
+  return dead.size();
+}
+
+bool destroy_entity(ViewId v, EntityId e) {
+  return destroy_entities(v, &e, 1) == 1;
+}
+
+std::size_t migrate_entities(ViewId v, const EntityId* es, std::size_t n, ArchetypeId to, EntityId* out) {
+  if (out) std::fill(out, out + n, kInvalidEntity);
+  if (!find_archetype(to)) return 0;
+  const ViewId dv = make_view(to); // may grow g_views; take references after
+  if (dv == v) {
+    std::size_t alive = 0;
+    for (std::size_t i = 0; i < n; ++i)
+      if (entity_alive(v, es[i])) { if (out) out[i] = es[i]; ++alive; }
+    return alive;
+  }
+  auto& S = g_views[(std::size_t)v-1];
+  auto& D = g_views[(std::size_t)dv-1];
+
+  // (source row, input index), in row order so the gathers walk forward.
+  std::vector<std::pair<std::uint32_t, std::size_t>> moving;
+  moving.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const std::uint32_t r = live_row(S, es[i]);
+    if (r != kNoRow) moving.push_back({r, i});
+  }
+  std::sort(moving.begin(), moving.end());
+  moving.erase(std::unique(moving.begin(), moving.end(),
+                           [](const auto& a, const auto& b){ return a.first == b.first; }),
+               moving.end());
+  if (moving.empty()) return 0;
+
+  // Pair the destination's copy of every double-buffered column, so the
+  // back rows travel with the front ones below.
+  for (const auto& p : S.double_buffered) {
+    auto it = D.column_ids.find(S.columns[(std::size_t)p.first].path);
+    if (it != D.column_ids.end()) set_double_buffered(dv, it->second);
+  }
+
+  const std::size_t first = append_rows(D, moving.size());
+  for (const auto& dc : D.columns) {
+    auto it = S.column_ids.find(dc.path);
+    if (it == S.column_ids.end()) continue; // new component: stays zeroed
+    const ColumnData& sc = S.columns[(std::size_t)it->second];
+    if (sc.type != dc.type) continue;
+    // Copy runs that are consecutive in the source and inside both tiles.
+    for (std::size_t j = 0; j < moving.size();) {
+      const std::size_t src = moving[j].first, dst = first + j;
+      std::size_t run = 1;
+      const std::size_t max_run = std::min(S.tile_rows - src % S.tile_rows, D.tile_rows - dst % D.tile_rows);
+      while (run < max_run && j + run < moving.size() && moving[j + run].first == src + run) ++run;
+      std::memcpy(lane_ptr(D, dc, dst), lane_ptr(S, sc, src), run * dc.elem_size);
+      j += run;
+    }
+  }
+
+  std::vector<EntityId> gone(moving.size());
+  for (std::size_t j = 0; j < moving.size(); ++j) {
+    gone[j] = es[moving[j].second];
+    if (out) {
+      const std::uint32_t slot = D.slot_of_row[first + j];
+      out[moving[j].second] = make_entity(D.gen_of_slot[slot], slot);
+    }
+  }
+  destroy_entities(v, gone.data(), gone.size());
+  return moving.size();
+}
+
+std::size_t add_component(ViewId v, const EntityId* es, std::size_t n, const char* component, EntityId* out) {
+  const ArchetypeId to = archetype_with(g_views[(std::size_t)v-1].arch, component);
+  return migrate_entities(v, es, n, to, out);
+}
+
+std::size_t remove_component(ViewId v, const EntityId* es, std::size_t n, const char* component, EntityId* out) {
+  const ArchetypeId to = archetype_without(g_views[(std::size_t)v-1].arch, component);
+  return migrate_entities(v, es, n, to, out);
+}
+
+std::size_t view_capacity(ViewId v) {
+  return capacity(g_views[(std::size_t)v-1]);
+}
+
+std::size_t view_padded_len(ViewId v) {
+  return padded_len(g_views[(std::size_t)v-1]);
+}
+
+void set_column_alignment(std::size_t bytes) {
+  std::size_t a = kColumnAlign;
+  while (a < bytes) a <<= 1;
+  g_column_align = a;
+}
+
+int view_row_node(ViewId v, std::size_t row) {
+  const ViewRec& V = g_views[(std::size_t)v-1];
+  if (V.chunks.empty() || V.tile_rows == 0) return -1;
+  return chunk_node(row / V.tile_rows);
+}
+
+std::uint64_t change_clock() { return g_change_clock.load(std::memory_order_relaxed); }
+
+std::size_t change_block_rows(ViewId v) {
+  return change_rows_for(g_views[(std::size_t)v-1]);
+}
+
+void mark_changed(ViewId v, ColumnId c, std::size_t begin, std::size_t end) {
+  auto& V = g_views[(std::size_t)v-1];
+  if (c < 0 || (std::size_t)c >= V.columns.size()) return;
+  mark_rows(V, begin, std::min(end, V.len), c);
+}
+
+std::uint64_t column_version(ViewId v, ColumnId c) {
+  auto& V = g_views[(std::size_t)v-1];
+  if (c < 0 || (std::size_t)c >= V.columns.size()) return 0;
+  std::uint64_t ver = 0;
+  for (const auto& b : V.columns[(std::size_t)c].block_version) ver = std::max(ver, b.load(std::memory_order_relaxed));
+  return ver;
+}
+
+std::size_t changed_blocks(ViewId v, const ColumnId* cols, int k, std::uint64_t since,
+                           std::uint32_t* out, std::size_t max_out) {
+  auto& V = g_views[(std::size_t)v-1];
+  const std::size_t B = change_rows_for(V);
+  const std::size_t blocks = (V.len + B - 1) / B;
+  std::size_t n = 0;
+  for (std::size_t b = 0; b < blocks; ++b) {
+    bool changed = false;
+    for (int i = 0; i < k && !changed; ++i) {
+      if (cols[i] < 0 || (std::size_t)cols[i] >= V.columns.size()) continue;
+      const auto& bv = V.columns[(std::size_t)cols[i]].block_version;
+      changed = b < bv.size() && bv[b].load(std::memory_order_relaxed) > since;
+    }
+    if (!changed) continue;
+    if (out && n < max_out) out[n] = (std::uint32_t)b;
+    ++n;
+  }
+  return n;
+}
+
+std::size_t bytes_to_move(ViewId v) {
+  auto& V = g_views[(std::size_t)v-1];
+  return V.len * V.row_bytes;
+}
+
+LayoutKind entity_current_layout(ViewId v) {
+  auto& V = g_views[(std::size_t)v-1];
+  return V.layout;
+}
+
+bool transform_soa_to_aosoa(ViewId v, int T) {
+  auto& V = g_views[(std::size_t)v-1];
+  if (T <= 0 || V.layout == LayoutKind::Chunked) return false; // chunked storage is opt-in and kept
+  if (V.layout == LayoutKind::AoSoA && V.aosoa_tile == T) return true;
+  const std::size_t tiles = (V.len + (std::size_t)T - 1) / (std::size_t)T;
+  relayout(V, (std::size_t)T, std::max<std::size_t>(tiles, 1));
   V.layout = LayoutKind::AoSoA;
   V.aosoa_tile = T;
+  clear_padding(V); // padding unit is now the tile
+  stamp_all(V);
+  return true;
 }
 
-void transform_aosoa_to_soa(ViewId v) {
+bool transform_aosoa_to_soa(ViewId v) {
   auto& V = g_views[(std::size_t)v-1];
-  if (V.layout != LayoutKind::AoSoA) { V.layout = LayoutKind::SoA; V.aosoa_tile = 0; return; }
-  for (auto& kv : V.columns) {
-    auto& col = kv.second;
-    std::vector<std::uint8_t> dst(col.bytes.size());
-    std::memcpy(dst.data(), col.bytes.data(), col.bytes.size());
-    col.bytes.swap(dst);
-  }
+  if (V.layout == LayoutKind::Chunked) return false;
+  if (V.layout != LayoutKind::AoSoA) { V.layout = LayoutKind::SoA; V.aosoa_tile = 0; return true; }
+  relayout(V, align_up(std::max<std::size_t>(V.len, 1), kPadRows), 1);
   V.layout = LayoutKind::SoA; V.aosoa_tile = 0;
+  clear_padding(V);
+  stamp_all(V);
+  return true;
+}
+
+// Largest row count whose lane blocks, each padded to kLaneAlign, fit in a chunk.
+static std::size_t chunk_rows(const ViewRec& V, std::size_t chunk_bytes) {
+  if (V.row_bytes == 0) return 0;
+  std::size_t rows = chunk_bytes / V.row_bytes;
+  auto tile_size = [&](std::size_t n) {
+    std::size_t off = 0;
+    for (const auto& c : V.columns) off = align_up(off + n * c.elem_size, kLaneAlign);
+    return off;
+  };
+  while (rows > 0 && tile_size(rows) > chunk_bytes) --rows;
+  return rows;
+}
+
+std::size_t transform_to_chunked(ViewId v, std::size_t chunk_bytes) {
+  auto& V = g_views[(std::size_t)v-1];
+  const std::size_t rows = chunk_rows(V, chunk_bytes);
+  if (rows == 0) return 0;
+  if (V.layout == LayoutKind::Chunked && V.tile_rows == rows) return rows;
+
+  V.spare_chunks.clear();
+  V.chunk_bytes = chunk_bytes;
+  relayout(V, rows, std::max<std::size_t>((V.len + rows - 1) / rows, 1), true);
+  V.spare_chunks.clear(); // old chunks are the previous size
+  V.data = Buffer(); V.scratch = Buffer();
+  V.layout = LayoutKind::Chunked;
+  V.aosoa_tile = 0;
+  clear_padding(V);
+  stamp_all(V);
+  return rows;
+}
+
+// ---------------------------------------------------
+// Double-buffered columns
+// ---------------------------------------------------
+// Clock value at the last swap; back blocks stamped after it were written
+// this frame.
+static std::uint64_t g_last_swap = 0;
+
+static void copy_to_back(ViewRec& V, const ColumnData& front, const ColumnData& back, std::size_t row, std::size_t n) {
+  const std::ptrdiff_t delta = (std::ptrdiff_t)back.tile_off - (std::ptrdiff_t)front.tile_off;
+  for_each_run(V, front, row, n, [&](std::uint8_t* p, std::size_t run){ std::memcpy(p + delta, p, run * front.elem_size); });
+}
+
+ColumnId set_double_buffered(ViewId v, ColumnId c) {
+  auto& V = g_views[(std::size_t)v-1];
+  if (c < 0 || (std::size_t)c >= V.columns.size()) return kInvalidColumn;
+  for (const auto& p : V.double_buffered) {
+    if (p.first == c) return p.second;
+    if (p.second == c) return kInvalidColumn;
+  }
+
+  // The back buffer is one more column of the view, so retiles, growth,
+  // reorders and removals carry it along with every other column.
+  ColumnData back;
+  back.path = V.columns[(std::size_t)c].path + kNextSuffix;
+  back.type = V.columns[(std::size_t)c].type;
+  back.elem_size = V.columns[(std::size_t)c].elem_size;
+  back.back_buffer = true;
+  const ColumnId b = (ColumnId)V.columns.size();
+  V.column_ids[back.path] = b;
+  V.row_bytes += back.elem_size;
+  V.columns.push_back(std::move(back));
+
+  if (V.layout == LayoutKind::Chunked) {
+    const std::size_t rows = chunk_rows(V, V.chunk_bytes);
+    if (rows == 0) { // no longer fits a chunk
+      V.row_bytes -= V.columns.back().elem_size;
+      V.column_ids.erase(V.columns.back().path);
+      V.columns.pop_back();
+      return kInvalidColumn;
+    }
+    relayout(V, rows, std::max<std::size_t>((V.len + rows - 1) / rows, 1), true, 1);
+  } else if (V.tile_count > 0) {
+    relayout(V, V.tile_rows, V.tile_count, false, 1);
+  }
+
+  // Start the back buffer as a copy of the front.
+  copy_to_back(V, V.columns[(std::size_t)c], V.columns[(std::size_t)b], 0, V.len);
+  V.double_buffered.push_back({c, b});
+  stamp_all(V);
+  auto& behind = V.columns[(std::size_t)b].rows_behind;
+  std::fill(behind.begin(), behind.end(), 0);
+  return b;
+}
+
+ColumnId column_next(ViewId v, ColumnId c) {
+  for (const auto& p : g_views[(std::size_t)v-1].double_buffered)
+    if (p.first == c) return p.second;
+  return kInvalidColumn;
+}
+
+#ifndef NDEBUG
+// Rows neither side marked must still match; a difference means a kernel
+// wrote through a raw column pointer without mark_changed, and the swap will
+// lose that write. Warns once per pair.
+static void check_unmarked_writes(ViewRec& V, const ColumnData& f, ColumnData& b, std::size_t words) {
+  if (b.unmarked_warned) return;
+  for (std::size_t w = 0; w < words; ++w) {
+    const std::uint64_t marked = b.rows_written[w].load(std::memory_order_relaxed) | b.rows_behind[w];
+    if (marked == ~0ull) continue;
+    for (std::size_t i = 0; i < 64 && w * 64 + i < V.len; ++i) {
+      if (marked >> i & 1) continue;
+      const std::size_t r = w * 64 + i;
+      if (std::memcmp(lane_ptr(V, f, r), lane_ptr(V, b, r), f.elem_size) == 0) continue;
+      std::fprintf(stderr, "dynsoa: %s (row %zu) changed without mark_changed; the buffer swap drops such writes\n",
+                   f.path.c_str(), r);
+      b.unmarked_warned = true;
+      return;
+    }
+  }
+}
+#endif
+
+// A pair flips only if its back buffer was written this frame: the flip is
+// the tile offset swap, and the only rows copied are those the back buffer
+// lagged on (written the frame before, or restructured) and that this frame
+// did not rewrite. Rows skipped by the writer (an incremental kernel, a
+// partly written block) keep their current values instead of rolling back.
+void swap_column_buffers() {
+  for (auto& V : g_views) {
+    const std::size_t B = change_rows_for(V);
+    const std::size_t blocks = (V.len + B - 1) / B;
+    const std::size_t words = bit_words(V.len);
+    const std::uint64_t tail = V.len % 64 ? bit_span(0, V.len % 64) : ~0ull;
+    for (const auto& p : V.double_buffered) {
+      ColumnData& f = V.columns[(std::size_t)p.first];
+      ColumnData& b = V.columns[(std::size_t)p.second];
+      grow_blocks(f.block_version, blocks);
+      grow_blocks(b.block_version, blocks);
+      grow_blocks(b.rows_written, words);
+      if (b.rows_behind.size() < words) b.rows_behind.resize(words, 0);
+#ifndef NDEBUG
+      check_unmarked_writes(V, f, b, words);
+#endif
+      bool written = false;
+      for (std::size_t k = 0; k < blocks && !written; ++k)
+        written = b.block_version[k].load(std::memory_order_relaxed) > g_last_swap;
+      if (!written) continue;
+      for (std::size_t w = 0; w < words; ++w) {
+        const std::uint64_t live = w + 1 == words ? tail : ~0ull;
+        const std::uint64_t wrote = b.rows_written[w].exchange(0, std::memory_order_relaxed) & live;
+        const std::uint64_t stale = b.rows_behind[w] & ~wrote & live;
+        b.rows_behind[w] = wrote; // after the flip the old front lags on these
+        for (std::size_t i = 0; i < 64 && stale >> i;) {
+          if (!(stale >> i & 1)) { ++i; continue; }
+          std::size_t j = i;
+          while (j < 64 && (stale >> j & 1)) ++j;
+          copy_to_back(V, f, b, w * 64 + i, j - i);
+          i = j;
+        }
+      }
+      for (std::size_t k = 0; k < blocks; ++k) {
+        const std::uint64_t fv = f.block_version[k].load(std::memory_order_relaxed);
+        const std::uint64_t bv = b.block_version[k].load(std::memory_order_relaxed);
+        if (bv > g_last_swap) f.block_version[k].store(std::max(fv, bv), std::memory_order_relaxed); // the front's change
+        b.block_version[k].store(fv, std::memory_order_relaxed); // not written in the new frame
+      }
+      std::swap(f.tile_off, b.tile_off);
+    }
+  }
+  g_last_swap = change_clock();
 }
 
 } // namespace dynsoa
@@ -2,22 +2,262 @@
 
 #include "dynsoa/kernels.h"
 #include "dynsoa/metrics.h"
+#include "dynsoa/entity_store.h"
+#include "dynsoa/layout.h"
+#include "dynsoa/thread_pool.h"
+#include "dynsoa/perf_counters.h"
+#include "dynsoa/query.h"
+#include "dynsoa/memory.h"
+#include <algorithm>
 #include <chrono>
+#include <vector>
 
 namespace dynsoa {
 
 void begin_frame() { /* scheduler prep via scheduler_on_begin_frame */ }
 
 void run_kernel(const char* name, KernelFn fn, ViewId v, const KernelCtx& ctx) {
+  PerfCounts c0 = perf_thread_read();
   auto t0 = std::chrono::high_resolution_clock::now();
   fn(v, ctx);
   auto t1 = std::chrono::high_resolution_clock::now();
+  PerfCounts c1 = perf_thread_read();
   std::uint32_t us = (std::uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+  // An opaque serial call has no tile timings: p95/p99 stay 0 and the
+  // aggregates take tail latency from parallel runs only.
   Sample s; s.kernel = name; s.view = v; s.time_us = us;
+  perf_fill_sample(perf_delta(c0, c1), s);
   emit_metric(s);
   metrics_note_frame_end(v, s);
 }
 
+// Rows per scheduling unit: the AoSoA tile or chunk when the view is tiled
+// (so ranges never split a tile), else KernelCtx::tile, else a cache-sized
+// default.
+static std::size_t tile_rows_for(ViewId v, const KernelCtx& ctx) {
+  const LayoutKind k = current_layout(v);
+  if (k == LayoutKind::AoSoA || k == LayoutKind::Chunked) return view_tile_rows(v);
+  return ctx.tile > 0 ? (std::size_t)ctx.tile : 4096;
+}
+
+struct ParallelRun {
+  RangeKernelFn    fn;
+  ViewId           view;
+  const KernelCtx* ctx;
+  std::size_t      len;
+  std::size_t      tile_rows;     // one kernel call, and one latency sample, per tile
+  std::size_t      rows_per_task;
+  TileHistogram*   hist; // one per worker, merged after the run
+  PerfCounts*      perf; // one per worker, counted on the worker's own thread
+};
+
+// Per-worker accumulators of run_kernel_parallel, kept per calling thread so
+// steady-state calls do not allocate. A call nested in a task on the same
+// thread finds them busy and uses its own.
+struct ParallelScratch {
+  std::vector<TileHistogram> hist;
+  std::vector<PerfCounts>    perf;
+  bool busy = false;
+};
+static thread_local ParallelScratch t_parallel_scratch;
+
+// A task spans several tiles; the kernel is invoked tile by tile so the
+// histogram holds per-tile latencies rather than per-task sums.
+static void run_range(void* arg, std::size_t task, int worker) {
+  auto& R = *(ParallelRun*)arg;
+  const std::size_t b = task * R.rows_per_task;
+  const std::size_t e = std::min(R.len, b + R.rows_per_task);
+  TileHistogram& hist = R.hist[(std::size_t)worker];
+  PerfCounts c0 = perf_thread_read();
+  auto t0 = std::chrono::high_resolution_clock::now();
+  for (std::size_t tb = b; tb < e; tb += R.tile_rows) {
+    R.fn(R.view, *R.ctx, tb, std::min(e, tb + R.tile_rows));
+    auto t1 = std::chrono::high_resolution_clock::now();
+    hist.record((std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    t0 = t1;
+  }
+  R.perf[(std::size_t)worker].add(perf_delta(c0, perf_thread_read()));
+}
+
+static std::uint32_t ns_to_us_ceil(std::uint64_t ns) { return (std::uint32_t)((ns + 999) / 1000); }
+
+void run_kernel_parallel(const char* name, RangeKernelFn fn, ViewId v, const KernelCtx& ctx) {
+  constexpr std::size_t kTasksPerWorker = 4;
+  ParallelRun R;
+  R.fn = fn; R.view = v; R.ctx = &ctx; R.len = view_len(v);
+
+  // Whole tiles per task, aiming for a few tasks per worker so stealing can balance.
+  const std::size_t tile = std::max<std::size_t>(1, tile_rows_for(v, ctx));
+  const std::size_t tiles = (R.len + tile - 1) / tile;
+  R.tile_rows = tile;
+  const std::size_t target = (std::size_t)pool_workers() * kTasksPerWorker;
+  std::size_t tiles_per_task = std::max<std::size_t>(1, (tiles + target - 1) / target);
+  // Chunks striped across NUMA nodes: keep each task inside one stripe and
+  // seed it on a worker of that stripe's node.
+  const bool striped = R.len > 0 && view_row_node(v, 0) >= 0;
+  if (striped) {
+    tiles_per_task = std::min(tiles_per_task, kNumaStripeChunks);
+    while (kNumaStripeChunks % tiles_per_task) --tiles_per_task;
+  }
+  R.rows_per_task = tile * tiles_per_task;
+  const std::size_t tasks = (R.len + R.rows_per_task - 1) / R.rows_per_task;
+  ParallelScratch nested;
+  ParallelScratch& S = t_parallel_scratch.busy ? nested : t_parallel_scratch;
+  const std::size_t workers = (std::size_t)pool_workers();
+  S.busy = true;
+  S.hist.resize(workers);
+  S.perf.resize(workers);
+  for (std::size_t w = 0; w < workers; ++w) { S.hist[w].reset(); S.perf[w] = PerfCounts{}; }
+  R.hist = S.hist.data(); R.perf = S.perf.data();
+  std::vector<int> nodes;
+  if (striped)
+    for (std::size_t t = 0; t < tasks; ++t) nodes.push_back(view_row_node(v, t * R.rows_per_task));
+
+  auto t0 = std::chrono::high_resolution_clock::now();
+  pool_run(tasks, run_range, &R, striped ? nodes.data() : nullptr);
+  auto t1 = std::chrono::high_resolution_clock::now();
+
+  Sample s; s.kernel = name; s.view = v;
+  s.time_us = (std::uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+  for (std::size_t w = 1; w < workers; ++w) { R.hist[0].merge(R.hist[w]); R.perf[0].add(R.perf[w]); }
+  s.p95_tile_us = ns_to_us_ceil(R.hist[0].percentile_ns(0.95));
+  s.p99_tile_us = ns_to_us_ceil(R.hist[0].percentile_ns(0.99));
+  perf_fill_sample(R.perf[0], s);
+  S.busy = false;
+  emit_metric(s);
+  metrics_note_frame_end(v, s);
+}
+
+struct QueryTask {
+  ViewId      view;
+  std::size_t begin, end;
+  std::size_t tile_rows; // the view's scheduling unit; one kernel call and sample per tile
+  std::size_t slot;      // index of the view among the run's views
+};
+
+struct QueryRun {
+  RangeKernelFn    fn;
+  const KernelCtx* ctx;
+  std::size_t      views = 0;
+  std::vector<QueryTask>     tasks;
+  std::vector<std::uint64_t> ns;   // per task
+  std::vector<PerfCounts>    perf; // per task, counted on the thread that ran it
+  TileHistogram*   hist = nullptr; // per (worker, view slot), merged per view after the run
+};
+
+// Like run_range, a task may start mid-tile (changed blocks need not align),
+// so its first call runs to the next tile edge.
+static void run_query_task(void* arg, std::size_t task, int worker) {
+  auto& R = *(QueryRun*)arg;
+  const QueryTask& t = R.tasks[task];
+  TileHistogram& hist = R.hist[(std::size_t)worker * R.views + t.slot];
+  PerfCounts c0 = perf_thread_read();
+  auto t0 = std::chrono::high_resolution_clock::now();
+  const auto start = t0;
+  for (std::size_t tb = t.begin; tb < t.end;) {
+    const std::size_t te = std::min(t.end, (tb / t.tile_rows + 1) * t.tile_rows);
+    R.fn(t.view, *R.ctx, tb, te);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    hist.record((std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    t0 = t1;
+    tb = te;
+  }
+  R.perf[task] = perf_delta(c0, perf_thread_read());
+  R.ns[task] = (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t0 - start).count();
+}
+
+static void run_query_tasks(const char* name, QueryRun& R) {
+  R.ns.resize(R.tasks.size());
+  R.perf.resize(R.tasks.size());
+  ParallelScratch nested;
+  ParallelScratch& S = t_parallel_scratch.busy ? nested : t_parallel_scratch;
+  const std::size_t workers = (std::size_t)pool_workers();
+  S.busy = true;
+  S.hist.resize(std::max(S.hist.size(), workers * R.views));
+  for (std::size_t i = 0; i < workers * R.views; ++i) S.hist[i].reset();
+  R.hist = S.hist.data();
+
+  // Seed tasks over striped chunks on their node's workers.
+  std::vector<int> nodes(R.tasks.size());
+  bool striped = false;
+  for (std::size_t i = 0; i < R.tasks.size(); ++i) {
+    nodes[i] = view_row_node(R.tasks[i].view, R.tasks[i].begin);
+    striped = striped || nodes[i] >= 0;
+  }
+  pool_run(R.tasks.size(), run_query_task, &R, striped ? nodes.data() : nullptr);
+
+  // Tasks are grouped by view, so each view's samples are one contiguous span.
+  for (std::size_t i = 0; i < R.tasks.size();) {
+    const ViewId v = R.tasks[i].view;
+    TileHistogram& hist = R.hist[R.tasks[i].slot];
+    for (std::size_t w = 1; w < workers; ++w) hist.merge(R.hist[w * R.views + R.tasks[i].slot]);
+    PerfCounts perf;
+    std::uint64_t total_ns = 0;
+    for (; i < R.tasks.size() && R.tasks[i].view == v; ++i) {
+      perf.add(R.perf[i]);
+      total_ns += R.ns[i];
+    }
+    Sample s; s.kernel = name; s.view = v;
+    s.time_us = ns_to_us_ceil(total_ns);
+    s.p95_tile_us = ns_to_us_ceil(hist.percentile_ns(0.95));
+    s.p99_tile_us = ns_to_us_ceil(hist.percentile_ns(0.99));
+    perf_fill_sample(perf, s);
+    emit_metric(s);
+    metrics_note_frame_end(v, s);
+  }
+  S.busy = false;
+}
+
+void run_kernel_query(const char* name, RangeKernelFn fn, QueryId q, const KernelCtx& ctx) {
+  constexpr std::size_t kTasksPerWorker = 4;
+  const std::vector<ViewId> views = query_views(q);
+  QueryRun R;
+  R.fn = fn; R.ctx = &ctx;
+
+  // Same task sizing as run_kernel_parallel, but over the tiles of all views.
+  std::size_t total_tiles = 0;
+  for (ViewId v : views) {
+    const std::size_t tile = std::max<std::size_t>(1, tile_rows_for(v, ctx));
+    total_tiles += (view_len(v) + tile - 1) / tile;
+  }
+  if (total_tiles == 0) return;
+  const std::size_t target = (std::size_t)pool_workers() * kTasksPerWorker;
+  const std::size_t tiles_per_task = std::max<std::size_t>(1, (total_tiles + target - 1) / target);
+  for (ViewId v : views) {
+    const std::size_t len = view_len(v);
+    const std::size_t tile = std::max<std::size_t>(1, tile_rows_for(v, ctx));
+    const std::size_t step = tile * tiles_per_task;
+    for (std::size_t b = 0; b < len; b += step) R.tasks.push_back({v, b, std::min(len, b + step), tile, R.views});
+    ++R.views;
+  }
+  run_query_tasks(name, R);
+}
+
+void run_kernel_changed(const char* name, RangeKernelFn fn, ViewId v, const ColumnId* cols, int k,
+                        std::uint64_t since, const KernelCtx& ctx) {
+  const std::size_t len = view_len(v);
+  const std::size_t B = change_block_rows(v);
+  std::vector<std::uint32_t> blocks((len + B - 1) / B);
+  blocks.resize(changed_blocks(v, cols, k, since, blocks.data(), blocks.size()));
+  if (blocks.empty()) return;
+
+  // Adjacent changed blocks merge into one range, capped so there are still
+  // a few tasks per worker to steal.
+  constexpr std::size_t kTasksPerWorker = 4;
+  const std::size_t target = (std::size_t)pool_workers() * kTasksPerWorker;
+  const std::size_t max_blocks = std::max<std::size_t>(1, (blocks.size() + target - 1) / target);
+  QueryRun R;
+  R.fn = fn; R.ctx = &ctx; R.views = 1;
+  const std::size_t tile = std::max<std::size_t>(1, tile_rows_for(v, ctx));
+  for (std::size_t i = 0; i < blocks.size();) {
+    std::size_t j = i + 1;
+    while (j < blocks.size() && j - i < max_blocks && blocks[j] == blocks[j - 1] + 1) ++j;
+    R.tasks.push_back({v, blocks[i] * B, std::min(len, (blocks[j - 1] + 1) * B), tile, 0});
+    i = j;
+  }
+  run_query_tasks(name, R);
+}
+
 void end_frame() { /* scheduler acts in scheduler_on_end_frame */ }
 
 } // namespace dynsoa
@@ -6,10 +6,13 @@
 #include "dynsoa/metrics.h"
 #include "dynsoa/scheduler.h"
 #include <algorithm>
+#include <cmath>
 
 namespace dynsoa {
 
 static double mem_bw_bytes_per_us() { return 4096.0; } // heuristic
+static const char* const kMortonKeyComponent = "Position";
+static const char* const kPartitionKeyColumn = "Flags.mask";
 
 LayoutKind current_layout(ViewId v) {
   return entity_current_layout(v);
@@ -19,12 +22,12 @@ static std::size_t bytes_to_move_bridge(ViewId v) {
   return bytes_to_move(v);
 }
 
-static void soa_to_aosoa(ViewId v, int T) {
-  transform_soa_to_aosoa(v, T);
+static bool soa_to_aosoa(ViewId v, int T) {
+  return transform_soa_to_aosoa(v, T);
 }
 
-static void aosoa_to_soa(ViewId v) {
-  transform_aosoa_to_soa(v);
+static bool aosoa_to_soa(ViewId v) {
+  return transform_aosoa_to_soa(v);
 }
 
 RetilePlan plan_aosoa(ViewId v, int tile) {
@@ -60,13 +63,62 @@ RetilePlan plan_matrix(ViewId v, int block) {
   return p;
 }
 
-bool retile_to_soa(ViewId v) { aosoa_to_soa(v); return true; }
+// Spatial sort pays off through locality: better coalescing and fewer cache
+// misses for kernels that read neighbours. The sort itself is n log n on top
+// of moving every row once; a view still in that order gains nothing.
+RetilePlan plan_sort_morton(ViewId v) {
+  RetilePlan p; p.to = LayoutKind::MortonSorted;
+  if (morton_key_dims(v, kMortonKeyComponent) == 0) return p;
+  if (view_morton_sorted(v, kMortonKeyComponent)) return p;
+  const double bytes = (double)bytes_to_move_bridge(v);
+  const double n = (double)std::max<std::size_t>(view_len(v), 2);
+  p.est_cost_us = bytes / mem_bw_bytes_per_us() + 0.002 * n * std::log2(n);
+
+  FrameAgg a = aggregate(v, 3);
+  LearnState L = scheduler_learn_for();
+  double mem_term = std::max(0.0, 0.75 - a.mem_coalesce);
+  double l2_term  = std::max(0.0, a.l2_miss - 0.10);
+  double base     = (a.mean_us>0 ? a.mean_us : 400.0);
+
+  p.est_gain_us = base * (L.a_mem * (mem_term + l2_term));
+  p.est_gain_us = std::max(10.0, std::min(p.est_gain_us, base * 0.40));
+  return p;
+}
+
+// Grouping rows by behaviour bits pays off through branch divergence: every
+// tile (and every kernel loop over a group) then sees one flag pattern. It
+// costs one key sort plus a row move. A view still grouped by the same key
+// and mask has nothing to gain, so the plan carries zero gain.
+RetilePlan plan_partition_by_mask(ViewId v, std::uint32_t mask) {
+  RetilePlan p; p.to = LayoutKind::Partitioned; p.tile_or_block = (int)mask;
+  if (!partition_key_valid(v, kPartitionKeyColumn)) return p;
+  if (view_partitioned_by(v, kPartitionKeyColumn, mask)) return p;
+  const double bytes = (double)bytes_to_move_bridge(v);
+  const double n = (double)std::max<std::size_t>(view_len(v), 2);
+  p.est_cost_us = bytes / mem_bw_bytes_per_us() + 0.001 * n * std::log2(n);
+
+  FrameAgg a = aggregate(v, 3);
+  LearnState L = scheduler_learn_for();
+  double div_term = std::max(0.0, a.branch_div - 0.10);
+  double warp_term = std::max(0.0, 0.90 - a.warp_eff);
+  double base     = (a.mean_us>0 ? a.mean_us : 400.0);
+
+  p.est_gain_us = base * (L.a_div * (div_term + warp_term));
+  p.est_gain_us = std::max(10.0, std::min(p.est_gain_us, base * 0.40));
+  return p;
+}
+
+bool retile_to_soa(ViewId v) { return aosoa_to_soa(v); }
 
 bool retile(ViewId v, const RetilePlan& plan) {
   switch (plan.to) {
-    case LayoutKind::AoSoA: soa_to_aosoa(v, plan.tile_or_block); return true;
-    case LayoutKind::SoA:   aosoa_to_soa(v); return true;
+    case LayoutKind::AoSoA: return soa_to_aosoa(v, plan.tile_or_block);
+    case LayoutKind::SoA:   return aosoa_to_soa(v);
     case LayoutKind::Matrix: return true; // transient via acquire_matrix_block
+    case LayoutKind::MortonSorted: return transform_sort_morton(v, kMortonKeyComponent);
+    case LayoutKind::Partitioned:
+      return transform_partition_by_mask(v, kPartitionKeyColumn, (std::uint32_t)plan.tile_or_block);
+    case LayoutKind::Chunked: return transform_to_chunked(v) != 0;
     case LayoutKind::AoS:
     default: break;
   }
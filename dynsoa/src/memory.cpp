@@ -0,0 +1,220 @@
+// DynSoA Runtime SDK
+
+#include "dynsoa/memory.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__)
+  #include <sched.h>
+  #include <sys/mman.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#elif defined(_WIN32)
+  #include <malloc.h>
+#endif
+
+namespace dynsoa {
+
+namespace {
+
+std::mutex   g_policy_mu;
+MemoryPolicy g_policy;
+
+std::size_t align_up(std::size_t n, std::size_t a) { return (n + a - 1) / a * a; }
+
+// Parses sysfs lists such as "0-3,8,10-11".
+std::vector<int> parse_list(const std::string& s) {
+  std::vector<int> out;
+  const char* p = s.c_str();
+  while (*p) {
+    char* end = nullptr;
+    const long a = std::strtol(p, &end, 10);
+    if (end == p) break;
+    long b = a;
+    p = end;
+    if (*p == '-') { b = std::strtol(p + 1, &end, 10); p = end; }
+    for (long i = a; i <= b; ++i) out.push_back((int)i);
+    if (*p == ',') ++p;
+  }
+  return out;
+}
+
+std::string read_line(const std::string& path) {
+  std::string s;
+  if (FILE* f = std::fopen(path.c_str(), "r")) {
+    char buf[4096];
+    if (std::fgets(buf, sizeof(buf), f)) s = buf;
+    std::fclose(f);
+  }
+  return s;
+}
+
+// Online nodes and their CPUs, read once. Node ids are assumed dense, which
+// holds on the two- and four-socket hosts this targets.
+struct Topology {
+  std::vector<std::vector<int>> cpus; // per node
+
+  Topology() {
+#if defined(__linux__)
+    for (int n : parse_list(read_line("/sys/devices/system/node/online")))
+      if (n == (int)cpus.size())
+        cpus.push_back(parse_list(read_line("/sys/devices/system/node/node" + std::to_string(n) + "/cpulist")));
+#endif
+    if (cpus.empty()) cpus.emplace_back();
+  }
+};
+
+const Topology& topology() {
+  static const Topology t;
+  return t;
+}
+
+#if defined(__linux__)
+// <numaif.h> lives in libnuma's headers; the syscall needs only these.
+constexpr int      kMpolBind = 2, kMpolInterleave = 3;
+constexpr unsigned kMpolMfMove = 1u << 1;
+constexpr int      kMaxNodes = 1024;
+
+// Applies a memory policy to [p, p + bytes), both page aligned; best effort.
+void bind_range(void* p, std::size_t bytes, int mode, int node) {
+  unsigned long mask[kMaxNodes / (8 * sizeof(unsigned long))] = {};
+  const int nodes = numa_node_count();
+  auto set = [&](int n) { mask[(std::size_t)n / (8 * sizeof(unsigned long))] |= 1ul << ((std::size_t)n % (8 * sizeof(unsigned long))); };
+  if (mode == kMpolBind) { if (node < 0 || node >= nodes || node >= kMaxNodes) return; set(node); }
+  else for (int n = 0; n < nodes && n < kMaxNodes; ++n) set(n);
+  syscall(SYS_mbind, p, bytes, mode, mask, (unsigned long)kMaxNodes + 1, kMpolMfMove);
+}
+
+// Explicit huge-page mappings, which must be released with munmap. The
+// count lets storage_free skip the lock while none are live, which is the
+// usual case (no explicit huge pages, or the pool was empty).
+std::mutex g_maps_mu;
+std::unordered_map<void*, std::size_t> g_maps;
+std::atomic<std::size_t> g_map_count{0};
+#endif
+
+} // namespace
+
+// A Bind target outside [0, numa_node_count()) falls back to node 0.
+void set_memory_policy(const MemoryPolicy& p) {
+  MemoryPolicy q = p;
+  if (q.node < 0 || q.node >= numa_node_count()) q.node = 0;
+  std::lock_guard<std::mutex> lk(g_policy_mu);
+  g_policy = q;
+}
+
+MemoryPolicy memory_policy() {
+  std::lock_guard<std::mutex> lk(g_policy_mu);
+  return g_policy;
+}
+
+int numa_node_count() { return (int)topology().cpus.size(); }
+
+int numa_node_of_cpu(int cpu) {
+  const auto& t = topology();
+  for (std::size_t n = 0; n < t.cpus.size(); ++n)
+    for (int c : t.cpus[n]) if (c == cpu) return (int)n;
+  return 0;
+}
+
+bool numa_pin_thread(int node) {
+#if defined(__linux__)
+  const auto& t = topology();
+  if (node < 0 || node >= (int)t.cpus.size() || t.cpus[(std::size_t)node].empty()) return false;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int c : t.cpus[(std::size_t)node]) if (c < CPU_SETSIZE) CPU_SET(c, &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  (void)node;
+  return false;
+#endif
+}
+
+bool numa_striping() {
+  return memory_policy().numa == NumaPolicy::Interleave && numa_node_count() > 1;
+}
+
+void* storage_alloc(std::size_t bytes, std::size_t align, int node) {
+  const MemoryPolicy P = memory_policy();
+  const bool numa = P.numa != NumaPolicy::FirstTouch && numa_node_count() > 1;
+  const bool huge = P.huge_pages != HugePages::Off && bytes >= kHugePageBytes;
+#if defined(__linux__)
+  if (numa || huge) {
+    // Policies apply per page, so the block gets whole pages of its own.
+    const std::size_t page = (std::size_t)sysconf(_SC_PAGESIZE);
+    if (align < page) align = page;
+    if (huge && align < kHugePageBytes) align = kHugePageBytes;
+    bytes = align_up(bytes, align);
+
+    void* p = nullptr;
+    if (huge && P.huge_pages == HugePages::Explicit && align <= kHugePageBytes) {
+      p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (p == MAP_FAILED) p = nullptr; // pool empty: fall back to THP
+      else {
+        std::lock_guard<std::mutex> lk(g_maps_mu);
+        g_maps[p] = bytes;
+        g_map_count.fetch_add(1, std::memory_order_release);
+      }
+    }
+    if (!p) {
+      if (posix_memalign(&p, align, bytes) != 0) return nullptr;
+      if (huge) madvise(p, bytes, MADV_HUGEPAGE);
+    }
+    if (node >= 0 && numa_node_count() > 1) bind_range(p, bytes, kMpolBind, node % numa_node_count());
+    else if (numa) bind_range(p, bytes, P.numa == NumaPolicy::Bind ? kMpolBind : kMpolInterleave, P.node);
+    return p;
+  }
+  void* p = nullptr;
+  return posix_memalign(&p, align, bytes) == 0 ? p : nullptr;
+#elif defined(_WIN32)
+  (void)node;
+  return _aligned_malloc(bytes, align);
+#else
+  (void)node;
+  void* p = nullptr;
+  return posix_memalign(&p, align, bytes) == 0 ? p : nullptr;
+#endif
+}
+
+void storage_free(void* p) {
+  if (!p) return;
+#if defined(__linux__)
+  // A mapping is counted before its pointer is handed out, so a free of it
+  // always sees a non-zero count.
+  if (g_map_count.load(std::memory_order_acquire) != 0) {
+    std::lock_guard<std::mutex> lk(g_maps_mu);
+    auto it = g_maps.find(p);
+    if (it != g_maps.end()) {
+      munmap(p, it->second);
+      g_maps.erase(it);
+      g_map_count.fetch_sub(1, std::memory_order_relaxed);
+      return;
+    }
+  }
+#endif
+#if defined(_WIN32)
+  _aligned_free(p);
+#else
+  std::free(p);
+#endif
+}
+
+void storage_place(void* p, std::size_t bytes, int node) {
+#if defined(__linux__)
+  if (!p || node < 0 || numa_node_count() < 2) return;
+  const std::size_t page = (std::size_t)sysconf(_SC_PAGESIZE);
+  // Only blocks from storage_alloc under a NUMA policy own whole pages.
+  if ((std::size_t)p % page != 0) return;
+  bind_range(p, align_up(bytes, page), kMpolBind, node % numa_node_count());
+#else
+  (void)p; (void)bytes; (void)node;
+#endif
+}
+
+} // namespace dynsoa
@@ -1,48 +1,163 @@
 // DynSoA Runtime SDK
 
 #include "dynsoa/metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
 #include <fstream>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <thread>
 #include <unordered_map>
-#include <deque>
-#include <cmath>
+#include <vector>
 
 namespace dynsoa {
 
-static std::mutex g_mu;
-static std::ofstream g_csv;
+namespace {
+
+// One ring entry. The kernel name is copied inline because callers (notably
+// the C API) may pass a string that does not outlive the call.
+struct Record {
+  Sample s;
+  bool   frame_end;
+  char   name[47];
+};
+
+// Single-producer / single-consumer ring. The owning thread pushes without
+// locking; consumers serialise on Metrics::drain_mu.
+struct Ring {
+  static constexpr std::size_t kCap = 1024; // power of two
+  static constexpr std::size_t kWakeFill = kCap / 2; // the push reaching this fill wakes the drainer
+  Record slots[kCap];
+  alignas(64) std::atomic<std::size_t> head{0}; // written by the producer
+  alignas(64) std::atomic<std::size_t> tail{0}; // written by the consumer
+  std::atomic<bool> retired{false};             // producer thread has exited
+
+  // Returns the fill level after the push, or 0 when the ring is full.
+  std::size_t push(const Sample& s, bool frame_end) {
+    const std::size_t h = head.load(std::memory_order_relaxed);
+    const std::size_t t = tail.load(std::memory_order_acquire);
+    if (h - t == kCap) return 0;
+    Record& r = slots[h & (kCap - 1)];
+    r.s = s;
+    r.frame_end = frame_end;
+    std::strncpy(r.name, s.kernel ? s.kernel : "", sizeof(r.name) - 1);
+    r.name[sizeof(r.name) - 1] = '\0';
+    head.store(h + 1, std::memory_order_release);
+    return h + 1 - t;
+  }
+};
 
 struct AggState {
   std::deque<Sample> window;
   FrameAgg ewma;
 };
 
-static std::unordered_map<ViewId, AggState> g_agg;
+struct Metrics {
+  std::mutex rings_mu;                      // registration only
+  std::vector<std::unique_ptr<Ring>> rings;
 
-void metrics_enable_csv(const char* path) {
-  std::lock_guard<std::mutex> lk(g_mu);
-  if (g_csv.is_open()) g_csv.close();
-  g_csv.open(path, std::ios::out | std::ios::trunc);
-  if (g_csv.is_open()) {
-    g_csv << "kernel,view,time_us,p95_tile_us,p99_tile_us,warp_eff,branch_div,mem_coalesce,l2_miss_rate\n";
-    g_csv.flush();
+  std::mutex drain_mu;                      // consumer side: rings' tails, csv, agg
+  std::ofstream csv;
+  std::string batch;
+  std::unordered_map<ViewId, AggState> agg;
+
+  std::atomic<std::uint64_t> dropped{0};
+
+  // The drainer sleeps until a ring half fills or kIdle passes; the
+  // scheduler flushes synchronously at frame end, so the timeout only bounds
+  // CSV latency and the retirement of idle threads' rings.
+  static constexpr std::chrono::seconds kIdle{1};
+  std::mutex thread_mu;
+  std::condition_variable cv;
+  std::thread drainer;
+  bool stop = false;                // set once by shutdown(), never cleared
+  bool pending = false;             // a producer asked for a drain
+  std::atomic<bool> started{false}; // start_drainer() has run; stays set after shutdown
+
+  ~Metrics() { shutdown(); }
+
+  void start_drainer() {
+    std::lock_guard<std::mutex> lk(thread_mu);
+    started.store(true, std::memory_order_relaxed);
+    if (drainer.joinable() || stop) return;
+    drainer = std::thread([this]{
+      std::unique_lock<std::mutex> lk(thread_mu);
+      while (!stop) {
+        cv.wait_for(lk, kIdle, [this]{ return stop || pending; });
+        pending = false;
+        lk.unlock();
+        drain();
+        lk.lock();
+      }
+    });
   }
-}
 
-void emit_metric(const Sample& s) {
-  std::lock_guard<std::mutex> lk(g_mu);
-  if (g_csv.is_open()) {
-    g_csv << s.kernel << "," << s.view << "," << s.time_us << ","
-          << s.p95_tile_us << "," << s.p99_tile_us << ","
-          << s.warp_eff << "," << s.branch_div << ","
-          << s.mem_coalesce << "," << s.l2_miss_rate << "\n";
+  void wake() {
+    {
+      std::lock_guard<std::mutex> lk(thread_mu);
+      pending = true;
+    }
+    cv.notify_one();
   }
-  g_agg[s.view].window.push_back(s);
-  if (g_agg[s.view].window.size() > 120) g_agg[s.view].window.pop_front();
+
+  // Final: later samples stay in their rings until a metrics_flush().
+  void shutdown() {
+    {
+      std::lock_guard<std::mutex> lk(thread_mu);
+      stop = true;
+    }
+    cv.notify_all();
+    if (drainer.joinable()) drainer.join();
+    drain();
+    std::lock_guard<std::mutex> lk(drain_mu);
+    if (csv.is_open()) csv.flush();
+  }
+
+  void drain();
+  void consume(Record& r);
+};
+
+Metrics& metrics() {
+  static Metrics m;
+  return m;
 }
 
-void metrics_note_frame_end(ViewId v, const Sample& s) {
-  auto& E = g_agg[v].ewma;
+// Marks the thread's ring retired on thread exit; the drainer frees it once
+// it has been emptied.
+struct RingHandle {
+  Ring* ring = nullptr;
+  ~RingHandle() { if (ring) ring->retired.store(true, std::memory_order_release); }
+};
+
+thread_local RingHandle t_ring;
+
+Ring* thread_ring() {
+  if (t_ring.ring) return t_ring.ring;
+  Metrics& M = metrics();
+  auto r = std::make_unique<Ring>();
+  t_ring.ring = r.get();
+  std::lock_guard<std::mutex> lk(M.rings_mu);
+  M.rings.push_back(std::move(r));
+  return t_ring.ring;
+}
+
+void record(const Sample& s, bool frame_end) {
+  Metrics& M = metrics();
+  if (!M.started.load(std::memory_order_relaxed)) M.start_drainer();
+  const std::size_t fill = thread_ring()->push(s, frame_end);
+  if (fill == 0) M.dropped.fetch_add(1, std::memory_order_relaxed);
+  else if (fill == Ring::kWakeFill) M.wake();
+}
+
+void note_frame_end(AggState& A, const Sample& s) {
+  auto& E = A.ewma;
   const double a = 0.2;
   auto lerp = [&](double cur, double obs){ return (1-a)*cur + a*obs; };
   E.mean_us      = (E.mean_us==0) ? s.time_us : lerp(E.mean_us, s.time_us);
@@ -50,25 +165,142 @@ void metrics_note_frame_end(ViewId v, const Sample& s) {
   E.branch_div   = lerp(E.branch_div, s.branch_div);
   E.mem_coalesce = lerp(E.mem_coalesce, s.mem_coalesce);
   E.l2_miss      = lerp(E.l2_miss, s.l2_miss_rate);
-  E.p95_us       = (E.p95_us==0)? s.p95_tile_us : lerp(E.p95_us, s.p95_tile_us);
-  E.p99_us       = (E.p99_us==0)? s.p99_tile_us : lerp(E.p99_us, s.p99_tile_us);
+  if (s.p95_tile_us > 0) { // serial runs carry no tile timings
+    E.p95_us     = (E.p95_us==0)? s.p95_tile_us : lerp(E.p95_us, s.p95_tile_us);
+    E.p99_us     = (E.p99_us==0)? s.p99_tile_us : lerp(E.p99_us, s.p99_tile_us);
+  }
   E.tail_ratio   = (E.p95_us>0) ? (E.p99_us / E.p95_us) : 0.0;
 }
 
+// Caller holds drain_mu.
+void Metrics::consume(Record& r) {
+  Sample& s = r.s;
+  AggState& A = agg[s.view];
+  if (r.frame_end) { note_frame_end(A, s); return; }
+  if (csv.is_open()) {
+    char line[320];
+    int n = std::snprintf(line, sizeof(line),
+      "%s,%llu,%u,%u,%u,%g,%g,%g,%g,%llu,%llu,%llu,%llu\n",
+      r.name, (unsigned long long)s.view, s.time_us, s.p95_tile_us, s.p99_tile_us,
+      s.warp_eff, s.branch_div, s.mem_coalesce, s.l2_miss_rate,
+      (unsigned long long)s.cpu_instructions, (unsigned long long)s.cpu_branch_misses,
+      (unsigned long long)s.cpu_cache_misses, (unsigned long long)s.cpu_llc_misses);
+    if (n > 0) batch.append(line, (std::size_t)std::min(n, (int)sizeof(line) - 1));
+  }
+  s.kernel = nullptr; // the inline name does not outlive the ring slot
+  A.window.push_back(s);
+  if (A.window.size() > 120) A.window.pop_front();
+}
+
+void Metrics::drain() {
+  std::lock_guard<std::mutex> dl(drain_mu);
+  std::lock_guard<std::mutex> rl(rings_mu);
+  for (std::size_t i = 0; i < rings.size();) {
+    Ring& R = *rings[i];
+    const bool retired = R.retired.load(std::memory_order_acquire);
+    std::size_t t = R.tail.load(std::memory_order_relaxed);
+    const std::size_t h = R.head.load(std::memory_order_acquire);
+    for (; t != h; ++t) consume(R.slots[t & (Ring::kCap - 1)]);
+    R.tail.store(t, std::memory_order_release);
+    if (retired) { rings[i] = std::move(rings.back()); rings.pop_back(); }
+    else ++i;
+  }
+  if (!batch.empty() && csv.is_open()) {
+    csv.write(batch.data(), (std::streamsize)batch.size());
+    csv.flush();
+  }
+  batch.clear();
+}
+
+} // namespace
+
+static int bucket_of(std::uint64_t ns) {
+  if (ns < (std::uint64_t)TileHistogram::kSub) return (int)ns;
+  int msb = 63;
+  while (!(ns >> msb)) --msb;
+  const int shift = msb - TileHistogram::kSubBits;
+  const int sub = (int)((ns >> shift) & (TileHistogram::kSub - 1));
+  return (shift + 1) * TileHistogram::kSub + sub;
+}
+
+static std::uint64_t bucket_upper(int b) {
+  if (b < TileHistogram::kSub) return (std::uint64_t)b;
+  const int shift = b / TileHistogram::kSub - 1;
+  const std::uint64_t sub = (std::uint64_t)(b % TileHistogram::kSub) + TileHistogram::kSub;
+  return ((sub + 1) << shift) - 1;
+}
+
+void TileHistogram::record(std::uint64_t ns) {
+  ++counts[bucket_of(ns)];
+  ++total;
+}
+
+void TileHistogram::merge(const TileHistogram& o) {
+  for (int i=0;i<kBuckets;++i) counts[i] += o.counts[i];
+  total += o.total;
+}
+
+void TileHistogram::reset() {
+  if (total == 0) return;
+  std::memset(counts, 0, sizeof(counts));
+  total = 0;
+}
+
+std::uint64_t TileHistogram::percentile_ns(double q) const {
+  if (total == 0) return 0;
+  const std::uint64_t rank = (std::uint64_t)std::ceil(q * (double)total);
+  std::uint64_t seen = 0;
+  for (int i=0;i<kBuckets;++i) {
+    seen += counts[i];
+    if (seen >= std::max<std::uint64_t>(rank, 1)) return bucket_upper(i);
+  }
+  return bucket_upper(kBuckets-1);
+}
+
+void metrics_enable_csv(const char* path) {
+  Metrics& M = metrics();
+  M.drain(); // samples emitted so far belong to the previous file
+  std::lock_guard<std::mutex> lk(M.drain_mu);
+  if (M.csv.is_open()) M.csv.close();
+  M.csv.open(path, std::ios::out | std::ios::trunc);
+  if (M.csv.is_open()) {
+    M.csv << "kernel,view,time_us,p95_tile_us,p99_tile_us,warp_eff,branch_div,mem_coalesce,l2_miss_rate,"
+             "cpu_instructions,cpu_branch_misses,cpu_cache_misses,cpu_llc_misses\n";
+    M.csv.flush();
+  }
+}
+
+void emit_metric(const Sample& s) { record(s, false); }
+
+void metrics_note_frame_end(ViewId v, const Sample& s) {
+  Sample f = s; f.view = v;
+  record(f, true);
+}
+
+void metrics_flush() { metrics().drain(); }
+
+void metrics_shutdown() { metrics().shutdown(); }
+
+std::uint64_t metrics_dropped() { return metrics().dropped.load(std::memory_order_relaxed); }
+
 FrameAgg aggregate(ViewId v, int window_frames) {
   FrameAgg A{};
-  auto it = g_agg.find(v);
-  if (it == g_agg.end()) return A;
+  Metrics& M = metrics();
+  std::lock_guard<std::mutex> lk(M.drain_mu);
+  auto it = M.agg.find(v);
+  if (it == M.agg.end()) return A;
   auto& dq = it->second.window;
-  int n = 0;
+  int n = 0, tiled = 0;
   for (int i=(int)dq.size()-1; i>=0 && n<window_frames; --i, ++n) {
     A.mean_us      += dq[i].time_us;
     A.warp_eff     += dq[i].warp_eff;
     A.branch_div   += dq[i].branch_div;
     A.mem_coalesce += dq[i].mem_coalesce;
     A.l2_miss      += dq[i].l2_miss_rate;
-    A.p95_us        = dq[i].p95_tile_us;
-    A.p99_us        = dq[i].p99_tile_us;
+    if (dq[i].p95_tile_us == 0) continue; // serial run: no tile timings
+    A.p95_us       += dq[i].p95_tile_us;
+    A.p99_us       += dq[i].p99_tile_us;
+    ++tiled;
   }
   if (n>0) {
     A.mean_us      /= n;
@@ -76,6 +308,10 @@ FrameAgg aggregate(ViewId v, int window_frames) {
     A.branch_div   /= n;
     A.mem_coalesce /= n;
     A.l2_miss      /= n;
+  }
+  if (tiled>0) {
+    A.p95_us       /= tiled;
+    A.p99_us       /= tiled;
     A.tail_ratio = (A.p95_us>0) ? (A.p99_us/A.p95_us) : 0;
   }
   return A;
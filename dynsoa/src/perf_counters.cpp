@@ -0,0 +1,186 @@
+// DynSoA Runtime SDK
+
+#include "dynsoa/perf_counters.h"
+#include "dynsoa/metrics.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace dynsoa {
+
+void PerfCounts::add(const PerfCounts& o) {
+  if (!o.valid) return;
+  instructions  += o.instructions;
+  branches      += o.branches;
+  branch_misses += o.branch_misses;
+  cache_refs    += o.cache_refs;
+  cache_misses  += o.cache_misses;
+  llc_misses    += o.llc_misses;
+  time_enabled  += o.time_enabled;
+  time_running  += o.time_running;
+  valid = true;
+}
+
+PerfCounts perf_delta(const PerfCounts& a, const PerfCounts& b) {
+  PerfCounts d;
+  if (!a.valid || !b.valid) return d;
+  d.time_enabled = b.time_enabled - a.time_enabled;
+  d.time_running = b.time_running - a.time_running;
+  // The group never reached the PMU in this window: the zeros mean nothing.
+  if (d.time_running == 0) return d;
+  // Multiplexed for part of the window; the group is scheduled as a unit so
+  // the ratios hold, but scale the totals up to the whole window.
+  const double scale = d.time_running < d.time_enabled
+                     ? (double)d.time_enabled / (double)d.time_running : 1.0;
+  auto diff = [&](std::uint64_t x, std::uint64_t y) {
+    return (std::uint64_t)((double)(y - x) * scale);
+  };
+  d.instructions  = diff(a.instructions,  b.instructions);
+  d.branches      = diff(a.branches,      b.branches);
+  d.branch_misses = diff(a.branch_misses, b.branch_misses);
+  d.cache_refs    = diff(a.cache_refs,    b.cache_refs);
+  d.cache_misses  = diff(a.cache_misses,  b.cache_misses);
+  d.llc_misses    = diff(a.llc_misses,    b.llc_misses);
+  d.valid = true;
+  return d;
+}
+
+static bool backend_enabled() {
+  static const bool on = []{
+    const char* v = std::getenv("DYNSOA_PERF");
+    return !(v && std::atoi(v) == 0);
+  }();
+  return on;
+}
+
+#if defined(__linux__)
+
+namespace {
+
+enum Slot { kInstr, kBranches, kBranchMiss, kCacheRef, kCacheMiss, kLlcMiss, kSlots };
+
+// One counter group per thread, led by instructions so all members are
+// scheduled onto the PMU together. Members the CPU lacks are left closed.
+struct ThreadCounters {
+  int  fd[kSlots];
+  int  index[kSlots]; // position of each slot in the group read, -1 if absent
+  int  members = 0;
+  bool tried = false;
+  bool ok = false;
+
+  ThreadCounters() { for (int i=0;i<kSlots;++i) { fd[i] = -1; index[i] = -1; } }
+  ~ThreadCounters() { for (int i=0;i<kSlots;++i) if (fd[i] >= 0) close(fd[i]); }
+
+  static int open_counter(std::uint32_t type, std::uint64_t config, int group) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group < 0 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+                     | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+  }
+
+  void open() {
+    tried = true;
+    fd[kInstr] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, -1);
+    if (fd[kInstr] < 0) return;
+    const std::uint64_t llc = PERF_COUNT_HW_CACHE_LL
+                            | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    struct { Slot s; std::uint32_t type; std::uint64_t cfg; } rest[] = {
+      {kBranches,   PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+      {kBranchMiss, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+      {kCacheRef,   PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES},
+      {kCacheMiss,  PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+      {kLlcMiss,    PERF_TYPE_HW_CACHE, llc},
+    };
+    index[kInstr] = members++;
+    for (auto& r : rest) {
+      fd[r.s] = open_counter(r.type, r.cfg, fd[kInstr]);
+      if (fd[r.s] >= 0) index[r.s] = members++;
+    }
+    ioctl(fd[kInstr], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ok = ioctl(fd[kInstr], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) == 0;
+  }
+
+  bool read(PerfCounts& out) {
+    // Group layout: nr, time_enabled, time_running, then one value per member.
+    std::uint64_t buf[3 + kSlots] = {};
+    const ssize_t want = (ssize_t)(sizeof(std::uint64_t) * (std::size_t)(3 + members));
+    if (::read(fd[kInstr], buf, (std::size_t)want) != want) return false;
+    auto at = [&](Slot s) -> std::uint64_t { return index[s] >= 0 ? buf[3 + index[s]] : 0; };
+    out.time_enabled  = buf[1];
+    out.time_running  = buf[2];
+    out.instructions  = at(kInstr);
+    out.branches      = at(kBranches);
+    out.branch_misses = at(kBranchMiss);
+    out.cache_refs    = at(kCacheRef);
+    out.cache_misses  = at(kCacheMiss);
+    out.llc_misses    = at(kLlcMiss);
+    out.valid = true;
+    return true;
+  }
+};
+
+thread_local ThreadCounters t_counters;
+
+ThreadCounters* thread_counters() {
+  if (!backend_enabled()) return nullptr;
+  if (!t_counters.tried) t_counters.open();
+  return t_counters.ok ? &t_counters : nullptr;
+}
+
+} // namespace
+
+bool perf_thread_available() { return thread_counters() != nullptr; }
+
+PerfCounts perf_thread_read() {
+  PerfCounts c;
+  if (ThreadCounters* tc = thread_counters()) tc->read(c);
+  return c;
+}
+
+#else
+
+bool perf_thread_available() { return false; }
+PerfCounts perf_thread_read() { return PerfCounts{}; }
+
+#endif
+
+// Mispredict rates run about 0.01-0.05 where warp divergence runs 0.1-0.5,
+// and the policy thresholds (branch_div - 0.15 and friends) were set for the
+// latter; scale so a 1.5% mispredict rate sits at the 0.15 knee.
+static constexpr float kMispredictToDivergence = 10.0f;
+
+void perf_fill_sample(const PerfCounts& c, Sample& s) {
+  if (!c.valid) return;
+  auto ratio = [](std::uint64_t num, std::uint64_t den) {
+    return den ? std::min(1.0f, (float)((double)num / (double)den)) : 0.0f;
+  };
+  s.cpu_instructions  = c.instructions;
+  s.cpu_branch_misses = c.branch_misses;
+  s.cpu_cache_misses  = c.cache_misses;
+  s.cpu_llc_misses    = c.llc_misses;
+  // CPU stand-ins for the GPU-flavoured signals the policy reads:
+  // scaled mispredict rate for divergence, share of cache refs that missed,
+  // and share of refs that stayed on chip for coalescing.
+  if (c.branches)
+    s.branch_div = std::min(1.0f, kMispredictToDivergence *
+                                      ratio(c.branch_misses, c.branches));
+  if (c.cache_refs) s.l2_miss_rate = ratio(c.cache_misses, c.cache_refs);
+  if (c.cache_refs) s.mem_coalesce = 1.0f - ratio(c.llc_misses, c.cache_refs);
+}
+
+} // namespace dynsoa
@@ -0,0 +1,51 @@
+// DynSoA Runtime SDK
+
+#include "dynsoa/query.h"
+#include "dynsoa/schema.h"
+#include "dynsoa/entity_store.h"
+#include <algorithm>
+#include <string>
+
+namespace dynsoa {
+
+namespace {
+
+struct QueryRec {
+  std::vector<std::string> required;
+  std::size_t scanned = 0; // archetypes 1..scanned have been tested
+  std::vector<ViewId> views;
+};
+
+std::vector<QueryRec> g_queries;
+
+bool matches(const QueryRec& Q, const ArchetypeDesc& a) {
+  return std::all_of(Q.required.begin(), Q.required.end(), [&](const std::string& c) {
+    return std::find(a.components.begin(), a.components.end(), c) != a.components.end();
+  });
+}
+
+void refresh(QueryRec& Q) {
+  for (const std::size_t n = archetype_count(); Q.scanned < n; ++Q.scanned) {
+    const ArchetypeId a = static_cast<ArchetypeId>(Q.scanned + 1);
+    if (matches(Q, *find_archetype(a))) Q.views.push_back(make_view(a));
+  }
+}
+
+} // namespace
+
+QueryId make_query(const char** components, int count) {
+  QueryRec Q;
+  for (int i = 0; i < count; ++i)
+    if (components[i]) Q.required.emplace_back(components[i]);
+  g_queries.push_back(std::move(Q));
+  return static_cast<QueryId>(g_queries.size()); // 1-based id
+}
+
+std::vector<ViewId> query_views(QueryId q) {
+  if (q == 0 || q > g_queries.size()) return {};
+  QueryRec& Q = g_queries[(std::size_t)q-1];
+  refresh(Q);
+  return Q.views;
+}
+
+} // namespace dynsoa
@@ -54,6 +54,15 @@ struct BanditStat {
 static std::unordered_map<ViewId, std::unordered_map<long long, BanditStat>> g_bandit;
 static int g_bandit_t = 0;
 
+// A candidate is applied only if its score clears kMinScore and its cost
+// fits the frame's retile budget.
+static const double kMinScore = 0.05;
+static const int    kRetileBudgetUs = 200000; // could be piped from Config
+
+static double plan_score(const RetilePlan& p, double priority) {
+  return priority * (p.est_gain_us / std::max(1.0, p.est_cost_us));
+}
+
 // candidate actions we consider each decision epoch
 static std::vector<RetilePlan> catalog_actions(ViewId v) {
   std::vector<RetilePlan> c;
@@ -61,12 +70,22 @@ static std::vector<RetilePlan> catalog_actions(ViewId v) {
   c.push_back(plan_aosoa(v, 128));
   c.push_back(plan_aosoa(v, 256));
   c.push_back(plan_matrix(v, 64));
+  RetilePlan m = plan_sort_morton(v);
+  if (m.est_gain_us > 0) c.push_back(m); // only views with a Position key, not still Morton-sorted
+  RetilePlan g = plan_partition_by_mask(v, 0);
+  if (g.est_gain_us > 0) c.push_back(g); // only views with a Flags.mask key, not already grouped by it
   return c;
 }
 
 // Choose via UCB1 on reward (realized_us - est_cost_us), with small epsilon exploration.
 // We use baseline p95/mean as context implicitly through reward; cheap but effective.
-static RetilePlan pick_with_ucb(ViewId v, const std::vector<RetilePlan>& C) {
+// Only arms the caller would apply are played, so an untried arm that is
+// always rejected cannot be returned forever; with none, the result has no gain.
+static RetilePlan pick_with_ucb(ViewId v, const std::vector<RetilePlan>& all, double priority) {
+  std::vector<RetilePlan> C;
+  for (const auto& p : all)
+    if (plan_score(p, priority) > kMinScore && p.est_cost_us <= kRetileBudgetUs) C.push_back(p);
+  if (C.empty()) return RetilePlan{};
   g_bandit_t++;
   double eps = 0.05; // exploration
   if ((double)std::rand() / RAND_MAX < eps) return C[std::rand() % C.size()];
@@ -79,7 +98,8 @@ static RetilePlan pick_with_ucb(ViewId v, const std::vector<RetilePlan>& C) {
     auto it = mp.find(key);
     double mean = 0.0; int n = 0;
     if (it != mp.end()) { mean = it->second.mean; n = it->second.n; }
-    double bonus = (n>0 ? std::sqrt(2.0 * std::log(std::max(2,g_bandit_t)) / n) : 1.0);
+    if (n == 0) return p; // play every arm once before trusting the bound
+    double bonus = std::sqrt(2.0 * std::log(std::max(2,g_bandit_t)) / n);
     double ucb = mean + bonus;
     if (ucb > best) { best = ucb; bestp = p; }
   }
@@ -103,6 +123,7 @@ static std::string g_persist_path = "dynsoa_learn.json";
 
 static std::unordered_map<ViewId,double> g_pre_action_baseline;
 static std::unordered_map<ViewId,int>    g_action_frame;
+static std::unordered_map<ViewId,RetilePlan> g_action_plan; // last applied, credited by the bandit
 
 static double field_value(const std::string& name, const FrameAgg& a) {
   if (name == "mean_us")       return a.mean_us;
@@ -159,7 +180,8 @@ void scheduler_on_begin_frame() { ++g_frame_idx; }
 
 void scheduler_on_end_frame() {
   ensure_verbose_init();
-struct Cand { ViewId v; RetilePlan plan; double score; };
+  metrics_flush(); // decide on this frame's samples, not whatever the drainer has reached
+struct Cand { ViewId v; RetilePlan plan; double score; bool bandit; };
   std::vector<Cand> C;
 
   for (ViewId v=1; v<=64; ++v) {
@@ -173,9 +195,12 @@ struct Cand { ViewId v; RetilePlan plan; double score; };
       if (t.action == "RETILE_AOSOA") p = plan_aosoa(v, t.arg);
       else if (t.action == "RETILE_SOA") { p.to = LayoutKind::SoA; }
       else if (t.action == "PACK_MATRIX") p = plan_matrix(v, t.arg);
+      else if (t.action == "RETILE_SORT_MORTON") p = plan_sort_morton(v);
+      else if (t.action == "PARTITION_BY_MASK") p = plan_partition_by_mask(v, (std::uint32_t)t.arg);
+      else if (t.action == "AUTO") p = pick_with_ucb(v, catalog_actions(v), t.priority);
 
-      double score = t.priority * (p.est_gain_us / std::max(1.0, p.est_cost_us));
-      if (score > 0.05) C.push_back({v, p, score});
+      double score = plan_score(p, t.priority);
+      if (score > kMinScore) C.push_back({v, p, score, t.action == "AUTO"});
     }
   }
 
@@ -184,21 +209,29 @@ struct Cand { ViewId v; RetilePlan plan; double score; };
     return a.v < b.v;
   });
 
-  int budget_us = 200000; // could be piped from Config
+  int budget_us = kRetileBudgetUs;
   int used = 0;
 
   for (auto& c : C) {
     if (used + (int)c.plan.est_cost_us <= budget_us) {
       FrameAgg before = aggregate(c.v, 3);
       double baseline = (before.p95_us>0 ? before.p95_us : (before.mean_us>0?before.mean_us:0.0));
-      if (baseline > 0) g_pre_action_baseline[c.v] = baseline;
 
-      if (c.plan.to == LayoutKind::SoA) retile_to_soa(c.v);
-      else                               retile(c.v, c.plan);
+      // A retile that does not apply (e.g. AoSoA on a chunked view) costs
+      // nothing and earns no cooldown or credit.
+      const bool applied = (c.plan.to == LayoutKind::SoA) ? retile_to_soa(c.v) : retile(c.v, c.plan);
+      // A bandit arm that is not applied (here or for budget) still counts
+      // as played with no realized gain, so the next pick moves on.
+      if (!applied) {
+        if (c.bandit) bandit_update(c.v, c.plan, 0.0);
+        continue;
+      }
+      if (baseline > 0) g_pre_action_baseline[c.v] = baseline;
 
       used += (int)c.plan.est_cost_us;
       g_cooldown[c.v] = g_policy.cooloff_frames;
       g_action_frame[c.v] = g_frame_idx;
+      g_action_plan[c.v] = c.plan;
       if (g_verbose) {
         char buf[512];
         std::snprintf(buf, sizeof(buf),
@@ -206,13 +239,17 @@ struct Cand { ViewId v; RetilePlan plan; double score; };
           g_frame_idx, (unsigned long long)c.v,
           (c.plan.to == LayoutKind::AoSoA ? "RETILE_AOSOA" :
            c.plan.to == LayoutKind::SoA   ? "RETILE_SOA"   :
-           c.plan.to == LayoutKind::Matrix? "PACK_MATRIX"  : "UNKNOWN"),
+           c.plan.to == LayoutKind::Matrix? "PACK_MATRIX"  :
+           c.plan.to == LayoutKind::MortonSorted ? "RETILE_SORT_MORTON" :
+           c.plan.to == LayoutKind::Partitioned  ? "PARTITION_BY_MASK"  : "UNKNOWN"),
           (int)c.plan.to, c.plan.tile_or_block,
           c.plan.est_cost_us, c.plan.est_gain_us, c.score, baseline,
           g_learn.a_div, g_learn.a_mem, g_learn.a_tail);
         if (g_learn_csv.is_open()) g_learn_csv << buf << "\n";
         vprint(std::string("scheduler: applied action: ") + buf);
       }
+    } else if (c.bandit) {
+      bandit_update(c.v, c.plan, 0.0); // over budget: played, no gain
     }
   }
 
@@ -256,6 +293,8 @@ struct Cand { ViewId v; RetilePlan plan; double score; };
       if (g_learn_csv.is_open()) g_learn_csv << buf << "\n";
       vprint(std::string("scheduler: learned: ") + buf);
     }
+    auto plan_it = g_action_plan.find(v);
+    if (plan_it != g_action_plan.end()) bandit_update(v, plan_it->second, realized_gain);
     g_pre_action_baseline.erase(v);
 }
 }
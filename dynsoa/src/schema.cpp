@@ -1,13 +1,32 @@
 // DynSoA Runtime SDK
 
 #include "dynsoa/schema.h"
+#include <algorithm>
 #include <unordered_map>
 
 namespace dynsoa {
-static std::unordered_map<std::string, Component> g_components;
+static std::unordered_map<std::string, ComponentDesc> g_components;
 static std::vector<ArchetypeDesc> g_archetypes;
 
-void define_component(const Component& c) { g_components[c.name] = c; }
+// Add/remove transitions out of one archetype, keyed by component name.
+struct ArchetypeEdges {
+  std::unordered_map<std::string, ArchetypeId> add, remove;
+};
+static std::vector<ArchetypeEdges> g_edges; // parallel to g_archetypes
+
+void define_component(const Component& c) {
+  if (!c.name) return;
+  ComponentDesc desc;
+  desc.name = c.name;
+  desc.fields.reserve(c.field_count > 0 ? c.field_count : 0);
+  for (int i=0;i<c.field_count;++i) {
+    FieldDesc f;
+    f.name = c.fields[i].name ? c.fields[i].name : "";
+    f.type = c.fields[i].type;
+    desc.fields.push_back(std::move(f));
+  }
+  g_components[desc.name] = std::move(desc);
+}
 
 ArchetypeId define_archetype(const char* name, const char** comps, int count) {
   ArchetypeDesc desc;
@@ -15,7 +34,82 @@ ArchetypeId define_archetype(const char* name, const char** comps, int count) {
   desc.components.reserve(count);
   for (int i=0;i<count;++i) desc.components.emplace_back(comps[i]);
   g_archetypes.push_back(desc);
+  g_edges.emplace_back();
   return static_cast<ArchetypeId>(g_archetypes.size()); // 1-based id
 }
 
+// Existing archetype with exactly this component set (any order), or 0.
+static ArchetypeId find_archetype_set(std::vector<std::string> comps) {
+  std::sort(comps.begin(), comps.end());
+  for (std::size_t i = 0; i < g_archetypes.size(); ++i) {
+    if (g_archetypes[i].components.size() != comps.size()) continue;
+    std::vector<std::string> have = g_archetypes[i].components;
+    std::sort(have.begin(), have.end());
+    if (have == comps) return static_cast<ArchetypeId>(i+1);
+  }
+  return 0;
+}
+
+// Slow path of an edge lookup: scan for the set, defining it if absent.
+static ArchetypeId resolve_edge(ArchetypeId arch, const std::string& comp, bool add) {
+  std::vector<std::string> comps = g_archetypes[(std::size_t)arch-1].components;
+  std::string name = g_archetypes[(std::size_t)arch-1].name;
+  auto it = std::find(comps.begin(), comps.end(), comp);
+  if (add == (it != comps.end())) return arch;
+  if (add) comps.push_back(comp); else comps.erase(it);
+  if (ArchetypeId found = find_archetype_set(comps)) return found;
+
+  name += (add ? "+" : "-") + comp;
+  std::vector<const char*> names;
+  for (const auto& c : comps) names.push_back(c.c_str());
+  return define_archetype(name.c_str(), names.data(), (int)names.size());
+}
+
+static ArchetypeId follow_edge(ArchetypeId arch, const char* component, bool add) {
+  if (!component || !find_archetype(arch)) return 0;
+  auto& edges = add ? g_edges[(std::size_t)arch-1].add : g_edges[(std::size_t)arch-1].remove;
+  auto it = edges.find(component);
+  if (it != edges.end()) return it->second;
+  const ArchetypeId to = resolve_edge(arch, component, add);
+  // resolve_edge may have grown g_edges; index again.
+  (add ? g_edges[(std::size_t)arch-1].add : g_edges[(std::size_t)arch-1].remove)[component] = to;
+  return to;
+}
+
+ArchetypeId archetype_with(ArchetypeId arch, const char* component) {
+  return follow_edge(arch, component, true);
+}
+
+ArchetypeId archetype_without(ArchetypeId arch, const char* component) {
+  return follow_edge(arch, component, false);
+}
+
+const ArchetypeDesc* find_archetype(ArchetypeId arch) {
+  if (arch == 0 || arch > g_archetypes.size()) return nullptr;
+  return &g_archetypes[(std::size_t)arch-1];
+}
+
+std::size_t archetype_count() { return g_archetypes.size(); }
+
+const ComponentDesc* find_component(const std::string& name) {
+  auto it = g_components.find(name);
+  return it == g_components.end() ? nullptr : &it->second;
+}
+
+std::string column_path(const std::string& comp, const std::string& field) {
+  if (field.compare(0, comp.size()+1, comp + ".") == 0) return field;
+  return comp + "." + field;
+}
+
+std::size_t scalar_size(ScalarType t) {
+  switch (t) {
+    case ScalarType::F32: return sizeof(float);
+    case ScalarType::I32: return sizeof(std::int32_t);
+    case ScalarType::U32: return sizeof(std::uint32_t);
+    case ScalarType::F64: return sizeof(double);
+    case ScalarType::I64: return sizeof(std::int64_t);
+  }
+  return sizeof(float);
+}
+
 } // namespace dynsoa
@@ -0,0 +1,628 @@
+// DynSoA Runtime SDK
+
+#include "dynsoa/simd.h"
+#include "dynsoa/entity_store.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #define DYNSOA_SIMD_X86 1
+  // GCC 12's AVX-512 headers trip -Wuninitialized on their own
+  // _mm512_undefined_* placeholders (GCC PR 105593).
+  #if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wuninitialized"
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+  #endif
+  #include <immintrin.h>
+  #if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic pop
+  #endif
+  #if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+    #define DYNSOA_TARGET(isa)
+  #else
+    #define DYNSOA_TARGET(isa) __attribute__((target(isa)))
+  #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+  #define DYNSOA_SIMD_NEON 1
+  #include <arm_neon.h>
+#endif
+
+namespace dynsoa {
+
+namespace {
+
+// Products and sums are separate statements and the file is built with
+// -ffp-contract=off, so no path is contracted into an FMA; that keeps
+// element-wise results identical.
+
+// ---------------- Scalar ----------------
+
+void axpy_scalar(float* y, const float* x, float a, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) { const float p = a * x[i]; y[i] += p; }
+}
+
+void axpy_masked_scalar(float* y, const float* x, float a, const std::uint32_t* f, std::uint32_t mask, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i)
+    if (f[i] & mask) { const float p = a * x[i]; y[i] += p; }
+}
+
+void clamp_length_scalar(float* x, float* y, float* z, float max_len, std::size_t n) {
+  const float m2 = max_len * max_len;
+  for (std::size_t i = 0; i < n; ++i) {
+    float s2 = x[i] * x[i];
+    const float yy = y[i] * y[i], zz = z[i] * z[i];
+    s2 += yy; s2 += zz;
+    if (s2 > m2) {
+      const float k = max_len * (1.0f / std::sqrt(s2));
+      x[i] *= k; y[i] *= k; z[i] *= k;
+    }
+  }
+}
+
+float sum_scalar(const float* x, std::size_t n) {
+  float s = 0.f;
+  for (std::size_t i = 0; i < n; ++i) s += x[i];
+  return s;
+}
+
+float min_scalar(const float* x, std::size_t n) {
+  float m = std::numeric_limits<float>::infinity();
+  for (std::size_t i = 0; i < n; ++i) m = x[i] < m ? x[i] : m;
+  return m;
+}
+
+float max_scalar(const float* x, std::size_t n) {
+  float m = -std::numeric_limits<float>::infinity();
+  for (std::size_t i = 0; i < n; ++i) m = x[i] > m ? x[i] : m;
+  return m;
+}
+
+void gather_scalar(float* out, const float* src, const std::uint32_t* idx, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) out[i] = src[idx[i]];
+}
+
+void scatter_scalar(float* dst, const float* src, const std::uint32_t* idx, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) dst[idx[i]] = src[i];
+}
+
+// ---------------- AVX2 / AVX-512 ----------------
+
+#if defined(DYNSOA_SIMD_X86)
+
+DYNSOA_TARGET("avx2")
+void axpy_avx2(float* y, const float* x, float a, std::size_t n) {
+  const __m256 va = _mm256_set1_ps(a);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(va, _mm256_loadu_ps(x + i))));
+  axpy_scalar(y + i, x + i, a, n - i);
+}
+
+DYNSOA_TARGET("avx2")
+void axpy_masked_avx2(float* y, const float* x, float a, const std::uint32_t* f, std::uint32_t mask, std::size_t n) {
+  const __m256 va = _mm256_set1_ps(a);
+  const __m256i vm = _mm256_set1_epi32((int)mask), zero = _mm256_setzero_si256();
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i hit = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(f + i)), vm);
+    const __m256 skip = _mm256_castsi256_ps(_mm256_cmpeq_epi32(hit, zero));
+    const __m256 vy = _mm256_loadu_ps(y + i);
+    const __m256 r = _mm256_add_ps(vy, _mm256_mul_ps(va, _mm256_loadu_ps(x + i)));
+    _mm256_storeu_ps(y + i, _mm256_blendv_ps(r, vy, skip));
+  }
+  axpy_masked_scalar(y + i, x + i, a, f + i, mask, n - i);
+}
+
+DYNSOA_TARGET("avx2")
+void clamp_length_avx2(float* x, float* y, float* z, float max_len, std::size_t n) {
+  const __m256 vmax = _mm256_set1_ps(max_len), m2 = _mm256_set1_ps(max_len * max_len);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i);
+    const __m256 s2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)), _mm256_mul_ps(vz, vz));
+    const __m256 over = _mm256_cmp_ps(s2, m2, _CMP_GT_OQ);
+    if (_mm256_movemask_ps(over) == 0) continue;
+    const __m256 k = _mm256_mul_ps(vmax, _mm256_div_ps(one, _mm256_sqrt_ps(s2)));
+    _mm256_storeu_ps(x + i, _mm256_blendv_ps(vx, _mm256_mul_ps(vx, k), over));
+    _mm256_storeu_ps(y + i, _mm256_blendv_ps(vy, _mm256_mul_ps(vy, k), over));
+    _mm256_storeu_ps(z + i, _mm256_blendv_ps(vz, _mm256_mul_ps(vz, k), over));
+  }
+  clamp_length_scalar(x + i, y + i, z + i, max_len, n - i);
+}
+
+DYNSOA_TARGET("avx2")
+float hsum_avx2(__m256 v) {
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+  return _mm_cvtss_f32(s);
+}
+
+DYNSOA_TARGET("avx2")
+float sum_avx2(const float* x, std::size_t n) {
+  __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    a0 = _mm256_add_ps(a0, _mm256_loadu_ps(x + i));
+    a1 = _mm256_add_ps(a1, _mm256_loadu_ps(x + i + 8));
+  }
+  for (; i + 8 <= n; i += 8) a0 = _mm256_add_ps(a0, _mm256_loadu_ps(x + i));
+  return hsum_avx2(_mm256_add_ps(a0, a1)) + sum_scalar(x + i, n - i);
+}
+
+// min/max take the loaded value first: on NaN the accumulator is kept, as
+// in the scalar compare.
+DYNSOA_TARGET("avx2")
+float min_avx2(const float* x, std::size_t n) {
+  __m256 m = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) m = _mm256_min_ps(_mm256_loadu_ps(x + i), m);
+  alignas(32) float lanes[8];
+  _mm256_store_ps(lanes, m);
+  return std::min(min_scalar(lanes, 8), min_scalar(x + i, n - i));
+}
+
+DYNSOA_TARGET("avx2")
+float max_avx2(const float* x, std::size_t n) {
+  __m256 m = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) m = _mm256_max_ps(_mm256_loadu_ps(x + i), m);
+  alignas(32) float lanes[8];
+  _mm256_store_ps(lanes, m);
+  return std::max(max_scalar(lanes, 8), max_scalar(x + i, n - i));
+}
+
+// The x86 gathers and scatters take signed 32-bit indices, so a vector
+// holding an index of 2^31 or more goes through the scalar loop instead.
+DYNSOA_TARGET("avx2")
+void gather_avx2(float* out, const float* src, const std::uint32_t* idx, std::size_t n) {
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i vi = _mm256_loadu_si256((const __m256i*)(idx + i));
+    if (_mm256_movemask_ps(_mm256_castsi256_ps(vi))) gather_scalar(out + i, src, idx + i, 8);
+    else _mm256_storeu_ps(out + i, _mm256_i32gather_ps(src, vi, 4));
+  }
+  gather_scalar(out + i, src, idx + i, n - i);
+}
+
+DYNSOA_TARGET("avx512f")
+void axpy_avx512(float* y, const float* x, float a, std::size_t n) {
+  const __m512 va = _mm512_set1_ps(a);
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+    _mm512_storeu_ps(y + i, _mm512_add_ps(_mm512_loadu_ps(y + i), _mm512_mul_ps(va, _mm512_loadu_ps(x + i))));
+  axpy_scalar(y + i, x + i, a, n - i);
+}
+
+DYNSOA_TARGET("avx512f")
+void axpy_masked_avx512(float* y, const float* x, float a, const std::uint32_t* f, std::uint32_t mask, std::size_t n) {
+  const __m512 va = _mm512_set1_ps(a);
+  const __m512i vm = _mm512_set1_epi32((int)mask);
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __mmask16 hit = _mm512_test_epi32_mask(_mm512_loadu_si512(f + i), vm);
+    const __m512 vy = _mm512_loadu_ps(y + i);
+    _mm512_storeu_ps(y + i, _mm512_mask_add_ps(vy, hit, vy, _mm512_mul_ps(va, _mm512_loadu_ps(x + i))));
+  }
+  axpy_masked_scalar(y + i, x + i, a, f + i, mask, n - i);
+}
+
+DYNSOA_TARGET("avx512f")
+void clamp_length_avx512(float* x, float* y, float* z, float max_len, std::size_t n) {
+  const __m512 vmax = _mm512_set1_ps(max_len), m2 = _mm512_set1_ps(max_len * max_len);
+  const __m512 one = _mm512_set1_ps(1.0f);
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512 vx = _mm512_loadu_ps(x + i), vy = _mm512_loadu_ps(y + i), vz = _mm512_loadu_ps(z + i);
+    const __m512 s2 = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(vx, vx), _mm512_mul_ps(vy, vy)), _mm512_mul_ps(vz, vz));
+    const __mmask16 over = _mm512_cmp_ps_mask(s2, m2, _CMP_GT_OQ);
+    if (over == 0) continue;
+    const __m512 k = _mm512_mul_ps(vmax, _mm512_div_ps(one, _mm512_sqrt_ps(s2)));
+    _mm512_storeu_ps(x + i, _mm512_mask_mul_ps(vx, over, vx, k));
+    _mm512_storeu_ps(y + i, _mm512_mask_mul_ps(vy, over, vy, k));
+    _mm512_storeu_ps(z + i, _mm512_mask_mul_ps(vz, over, vz, k));
+  }
+  clamp_length_scalar(x + i, y + i, z + i, max_len, n - i);
+}
+
+DYNSOA_TARGET("avx512f")
+float sum_avx512(const float* x, std::size_t n) {
+  __m512 a0 = _mm512_setzero_ps(), a1 = _mm512_setzero_ps();
+  std::size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    a0 = _mm512_add_ps(a0, _mm512_loadu_ps(x + i));
+    a1 = _mm512_add_ps(a1, _mm512_loadu_ps(x + i + 16));
+  }
+  for (; i + 16 <= n; i += 16) a0 = _mm512_add_ps(a0, _mm512_loadu_ps(x + i));
+  return _mm512_reduce_add_ps(_mm512_add_ps(a0, a1)) + sum_scalar(x + i, n - i);
+}
+
+DYNSOA_TARGET("avx512f")
+float min_avx512(const float* x, std::size_t n) {
+  __m512 m = _mm512_set1_ps(std::numeric_limits<float>::infinity());
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) m = _mm512_min_ps(_mm512_loadu_ps(x + i), m);
+  return std::min(_mm512_reduce_min_ps(m), min_scalar(x + i, n - i));
+}
+
+DYNSOA_TARGET("avx512f")
+float max_avx512(const float* x, std::size_t n) {
+  __m512 m = _mm512_set1_ps(-std::numeric_limits<float>::infinity());
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) m = _mm512_max_ps(_mm512_loadu_ps(x + i), m);
+  return std::max(_mm512_reduce_max_ps(m), max_scalar(x + i, n - i));
+}
+
+DYNSOA_TARGET("avx512f")
+void gather_avx512(float* out, const float* src, const std::uint32_t* idx, std::size_t n) {
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512i vi = _mm512_loadu_si512(idx + i);
+    if (_mm512_cmplt_epi32_mask(vi, _mm512_setzero_si512())) gather_scalar(out + i, src, idx + i, 16);
+    else _mm512_storeu_ps(out + i, _mm512_i32gather_ps(vi, src, 4));
+  }
+  gather_scalar(out + i, src, idx + i, n - i);
+}
+
+// Lanes are written lowest first, so duplicates resolve as in the scalar loop.
+DYNSOA_TARGET("avx512f")
+void scatter_avx512(float* dst, const float* src, const std::uint32_t* idx, std::size_t n) {
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512i vi = _mm512_loadu_si512(idx + i);
+    if (_mm512_cmplt_epi32_mask(vi, _mm512_setzero_si512())) scatter_scalar(dst, src + i, idx + i, 16);
+    else _mm512_i32scatter_ps(dst, vi, _mm512_loadu_ps(src + i), 4);
+  }
+  scatter_scalar(dst, src + i, idx + i, n - i);
+}
+
+bool cpu_supports(SimdLevel l) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int r[4];
+  __cpuid(r, 0);
+  if (r[0] < 7) return false;
+  __cpuid(r, 1);
+  if (!(r[2] & (1 << 27)) || !(r[2] & (1 << 28))) return false; // OSXSAVE, AVX
+  const unsigned long long xcr0 = _xgetbv(0);
+  __cpuidex(r, 7, 0);
+  if (l == SimdLevel::AVX2)   return (xcr0 & 0x6) == 0x6 && (r[1] & (1 << 5));
+  if (l == SimdLevel::AVX512) return (xcr0 & 0xe6) == 0xe6 && (r[1] & (1 << 16));
+  return false;
+#else
+  __builtin_cpu_init();
+  if (l == SimdLevel::AVX2)   return __builtin_cpu_supports("avx2");
+  if (l == SimdLevel::AVX512) return __builtin_cpu_supports("avx512f");
+  return false;
+#endif
+}
+
+#endif // DYNSOA_SIMD_X86
+
+// ---------------- NEON ----------------
+
+#if defined(DYNSOA_SIMD_NEON)
+
+void axpy_neon(float* y, const float* x, float a, std::size_t n) {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    vst1q_f32(y + i, vaddq_f32(vld1q_f32(y + i), vmulq_n_f32(vld1q_f32(x + i), a)));
+  axpy_scalar(y + i, x + i, a, n - i);
+}
+
+void axpy_masked_neon(float* y, const float* x, float a, const std::uint32_t* f, std::uint32_t mask, std::size_t n) {
+  const uint32x4_t vm = vdupq_n_u32(mask);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const uint32x4_t hit = vtstq_u32(vld1q_u32(f + i), vm);
+    const float32x4_t vy = vld1q_f32(y + i);
+    vst1q_f32(y + i, vbslq_f32(hit, vaddq_f32(vy, vmulq_n_f32(vld1q_f32(x + i), a)), vy));
+  }
+  axpy_masked_scalar(y + i, x + i, a, f + i, mask, n - i);
+}
+
+void clamp_length_neon(float* x, float* y, float* z, float max_len, std::size_t n) {
+  const float32x4_t m2 = vdupq_n_f32(max_len * max_len), one = vdupq_n_f32(1.0f);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const float32x4_t vx = vld1q_f32(x + i), vy = vld1q_f32(y + i), vz = vld1q_f32(z + i);
+    const float32x4_t s2 = vaddq_f32(vaddq_f32(vmulq_f32(vx, vx), vmulq_f32(vy, vy)), vmulq_f32(vz, vz));
+    const uint32x4_t over = vcgtq_f32(s2, m2);
+    if (vmaxvq_u32(over) == 0) continue;
+    const float32x4_t k = vmulq_n_f32(vdivq_f32(one, vsqrtq_f32(s2)), max_len);
+    vst1q_f32(x + i, vbslq_f32(over, vmulq_f32(vx, k), vx));
+    vst1q_f32(y + i, vbslq_f32(over, vmulq_f32(vy, k), vy));
+    vst1q_f32(z + i, vbslq_f32(over, vmulq_f32(vz, k), vz));
+  }
+  clamp_length_scalar(x + i, y + i, z + i, max_len, n - i);
+}
+
+float sum_neon(const float* x, std::size_t n) {
+  float32x4_t a0 = vdupq_n_f32(0.f), a1 = vdupq_n_f32(0.f);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    a0 = vaddq_f32(a0, vld1q_f32(x + i));
+    a1 = vaddq_f32(a1, vld1q_f32(x + i + 4));
+  }
+  for (; i + 4 <= n; i += 4) a0 = vaddq_f32(a0, vld1q_f32(x + i));
+  return vaddvq_f32(vaddq_f32(a0, a1)) + sum_scalar(x + i, n - i);
+}
+
+// vminnm/vmaxnm return the number when one side is NaN, like the scalar compare.
+float min_neon(const float* x, std::size_t n) {
+  float32x4_t m = vdupq_n_f32(std::numeric_limits<float>::infinity());
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) m = vminnmq_f32(m, vld1q_f32(x + i));
+  return std::min(vminnmvq_f32(m), min_scalar(x + i, n - i));
+}
+
+float max_neon(const float* x, std::size_t n) {
+  float32x4_t m = vdupq_n_f32(-std::numeric_limits<float>::infinity());
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) m = vmaxnmq_f32(m, vld1q_f32(x + i));
+  return std::max(vmaxnmvq_f32(m), max_scalar(x + i, n - i));
+}
+
+#endif // DYNSOA_SIMD_NEON
+
+// ---------------- Dispatch ----------------
+
+struct SimdOps {
+  SimdLevel level = SimdLevel::Scalar;
+  void  (*axpy)(float*, const float*, float, std::size_t) = axpy_scalar;
+  void  (*axpy_masked)(float*, const float*, float, const std::uint32_t*, std::uint32_t, std::size_t) = axpy_masked_scalar;
+  void  (*clamp_length)(float*, float*, float*, float, std::size_t) = clamp_length_scalar;
+  float (*sum)(const float*, std::size_t) = sum_scalar;
+  float (*min)(const float*, std::size_t) = min_scalar;
+  float (*max)(const float*, std::size_t) = max_scalar;
+  void  (*gather)(float*, const float*, const std::uint32_t*, std::size_t) = gather_scalar;
+  void  (*scatter)(float*, const float*, const std::uint32_t*, std::size_t) = scatter_scalar;
+};
+
+// DYNSOA_SIMD caps the level; unset (or unrecognised) means the widest the
+// CPU supports.
+SimdLevel requested_level() {
+  const char* s = std::getenv("DYNSOA_SIMD");
+  if (!s || !*s) return SimdLevel::AVX512;
+  if (std::strcmp(s, "scalar") == 0) return SimdLevel::Scalar;
+  if (std::strcmp(s, "neon") == 0)   return SimdLevel::NEON;
+  if (std::strcmp(s, "avx2") == 0)   return SimdLevel::AVX2;
+  if (std::strcmp(s, "avx512") == 0) return SimdLevel::AVX512;
+  std::fprintf(stderr, "dynsoa: unknown DYNSOA_SIMD=%s (expected scalar, neon, avx2 or avx512); auto-detecting\n", s);
+  return SimdLevel::AVX512;
+}
+
+SimdOps select_ops() {
+  SimdOps o;
+  const SimdLevel cap = requested_level();
+  (void)cap;
+#if defined(DYNSOA_SIMD_X86)
+  if (cap >= SimdLevel::AVX512 && cpu_supports(SimdLevel::AVX512)) {
+    o.level = SimdLevel::AVX512;
+    o.axpy = axpy_avx512; o.axpy_masked = axpy_masked_avx512; o.clamp_length = clamp_length_avx512;
+    o.sum = sum_avx512; o.min = min_avx512; o.max = max_avx512;
+    o.gather = gather_avx512; o.scatter = scatter_avx512;
+  } else if (cap >= SimdLevel::AVX2 && cpu_supports(SimdLevel::AVX2)) {
+    o.level = SimdLevel::AVX2;
+    o.axpy = axpy_avx2; o.axpy_masked = axpy_masked_avx2; o.clamp_length = clamp_length_avx2;
+    o.sum = sum_avx2; o.min = min_avx2; o.max = max_avx2;
+    o.gather = gather_avx2; // AVX2 has no scatter
+  }
+#elif defined(DYNSOA_SIMD_NEON)
+  if (cap >= SimdLevel::NEON) {
+    o.level = SimdLevel::NEON;
+    o.axpy = axpy_neon; o.axpy_masked = axpy_masked_neon; o.clamp_length = clamp_length_neon;
+    o.sum = sum_neon; o.min = min_neon; o.max = max_neon;
+  }
+#endif
+  return o;
+}
+
+const SimdOps& ops() {
+  static const SimdOps o = select_ops();
+  return o;
+}
+
+// Visit rows [begin, end) of a view as (tile, first lane, lane count).
+template <class Fn>
+void for_each_tile(ViewId v, std::size_t begin, std::size_t end, Fn&& fn) {
+  const std::size_t T = view_tile_rows(v);
+  if (T == 0) return;
+  end = std::min(end, view_len(v));
+  for (std::size_t r = begin; r < end;) {
+    const std::size_t k = r / T, i0 = r - k * T, m = std::min(T - i0, end - r);
+    fn(k, i0, m);
+    r += m;
+  }
+}
+
+bool is_f32(ViewId v, ColumnId c) { return column_has_type(v, c, ScalarType::F32); }
+
+// Largest of rows[0..n), 0 for n == 0.
+std::uint32_t max_row(const std::uint32_t* rows, std::size_t n) {
+  std::uint32_t hi = 0;
+  for (std::size_t i = 0; i < n; ++i) hi = std::max(hi, rows[i]);
+  return hi;
+}
+
+} // namespace
+
+SimdLevel simd_level() { return ops().level; }
+
+bool simd_matches_scalar() {
+  const SimdOps& o = ops();
+  const SimdOps s; // scalar defaults
+  std::uint32_t seed = 12345u;
+  auto rnd = [&] { seed = seed * 1664525u + 1013904223u; return seed; };
+  auto val = [&] { return (float)((int)(rnd() >> 8) % 20001 - 10000) * 0.0137f; };
+  auto same = [](const float* a, const float* b, std::size_t n) { return std::memcmp(a, b, n * sizeof(float)) == 0; };
+
+  // Every length up to a few vectors plus a long one, so main loops and tails both run.
+  std::vector<std::size_t> sizes;
+  for (std::size_t n = 0; n <= 80; ++n) sizes.push_back(n);
+  sizes.push_back(1037);
+  for (std::size_t n : sizes) {
+    std::vector<float> x(n), y(n), z(n), y2, x2, z2, src(n + 1);
+    std::vector<std::uint32_t> flags(n), idx(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      x[i] = val(); y[i] = val(); z[i] = (i % 7 == 0) ? 0.f : val();
+      flags[i] = rnd(); idx[i] = rnd() % (std::uint32_t)(n / 2 + 1); // duplicates on purpose
+    }
+    for (auto& f : src) f = val();
+
+    y2 = y; o.axpy(y2.data(), x.data(), 0.37f, n);
+    std::vector<float> ref = y; s.axpy(ref.data(), x.data(), 0.37f, n);
+    if (!same(y2.data(), ref.data(), n)) return false;
+
+    y2 = y; o.axpy_masked(y2.data(), x.data(), -1.25f, flags.data(), 0x5u, n);
+    ref = y; s.axpy_masked(ref.data(), x.data(), -1.25f, flags.data(), 0x5u, n);
+    if (!same(y2.data(), ref.data(), n)) return false;
+
+    x2 = x; y2 = y; z2 = z; o.clamp_length(x2.data(), y2.data(), z2.data(), 90.f, n);
+    std::vector<float> rx = x, ry = y, rz = z; s.clamp_length(rx.data(), ry.data(), rz.data(), 90.f, n);
+    if (!same(x2.data(), rx.data(), n) || !same(y2.data(), ry.data(), n) || !same(z2.data(), rz.data(), n)) return false;
+
+    o.gather(x2.data(), src.data(), idx.data(), n);
+    s.gather(rx.data(), src.data(), idx.data(), n);
+    if (!same(x2.data(), rx.data(), n)) return false;
+
+    std::vector<float> d1 = src, d2 = src;
+    o.scatter(d1.data(), x.data(), idx.data(), n);
+    s.scatter(d2.data(), x.data(), idx.data(), n);
+    if (!same(d1.data(), d2.data(), n + 1)) return false;
+  }
+  return true;
+}
+
+const char* simd_level_name(SimdLevel l) {
+  switch (l) {
+    case SimdLevel::Scalar: return "scalar";
+    case SimdLevel::NEON:   return "neon";
+    case SimdLevel::AVX2:   return "avx2";
+    case SimdLevel::AVX512: return "avx512";
+  }
+  return "scalar";
+}
+
+void simd_axpy(float* y, const float* x, float a, std::size_t n) { ops().axpy(y, x, a, n); }
+
+void simd_axpy_masked(float* y, const float* x, float a,
+                      const std::uint32_t* flags, std::uint32_t mask, std::size_t n) {
+  ops().axpy_masked(y, x, a, flags, mask, n);
+}
+
+void simd_clamp_length(float* x, float* y, float* z, float max_len, std::size_t n) {
+  ops().clamp_length(x, y, z, max_len, n);
+}
+
+float simd_sum(const float* x, std::size_t n) { return ops().sum(x, n); }
+float simd_min(const float* x, std::size_t n) { return ops().min(x, n); }
+float simd_max(const float* x, std::size_t n) { return ops().max(x, n); }
+
+void simd_gather(float* out, const float* src, const std::uint32_t* idx, std::size_t n) {
+  ops().gather(out, src, idx, n);
+}
+
+void simd_scatter(float* dst, const float* src, const std::uint32_t* idx, std::size_t n) {
+  ops().scatter(dst, src, idx, n);
+}
+
+void column_axpy(ViewId v, ColumnId y, ColumnId x, float a, std::size_t begin, std::size_t end) {
+  if (!is_f32(v, y) || !is_f32(v, x)) return;
+  for_each_tile(v, begin, end, [&](std::size_t k, std::size_t i0, std::size_t m) {
+    float* py = (float*)column_tile(v, y, k);
+    const float* px = (const float*)column_tile(v, x, k);
+    if (py && px) simd_axpy(py + i0, px + i0, a, m);
+  });
+  mark_changed(v, y, begin, end);
+}
+
+void column_axpy_masked(ViewId v, ColumnId y, ColumnId x, float a, ColumnId flags, std::uint32_t mask,
+                        std::size_t begin, std::size_t end) {
+  if (!is_f32(v, y) || !is_f32(v, x)) return;
+  if (!column_has_type(v, flags, ScalarType::U32) && !column_has_type(v, flags, ScalarType::I32)) return;
+  for_each_tile(v, begin, end, [&](std::size_t k, std::size_t i0, std::size_t m) {
+    float* py = (float*)column_tile(v, y, k);
+    const float* px = (const float*)column_tile(v, x, k);
+    const std::uint32_t* pf = (const std::uint32_t*)column_tile(v, flags, k);
+    if (py && px && pf) simd_axpy_masked(py + i0, px + i0, a, pf + i0, mask, m);
+  });
+  mark_changed(v, y, begin, end);
+}
+
+void column_clamp_length(ViewId v, ColumnId x, ColumnId y, ColumnId z, float max_len,
+                         std::size_t begin, std::size_t end) {
+  if (!is_f32(v, x) || !is_f32(v, y) || !is_f32(v, z)) return;
+  for_each_tile(v, begin, end, [&](std::size_t k, std::size_t i0, std::size_t m) {
+    float* px = (float*)column_tile(v, x, k);
+    float* py = (float*)column_tile(v, y, k);
+    float* pz = (float*)column_tile(v, z, k);
+    if (px && py && pz) simd_clamp_length(px + i0, py + i0, pz + i0, max_len, m);
+  });
+  for (ColumnId c : {x, y, z}) mark_changed(v, c, begin, end);
+}
+
+// Row indices are only vectorized when the view is one tile, where a row is
+// a flat index into the column; otherwise each row resolves its tile.
+void column_gather(ViewId v, ColumnId c, const std::uint32_t* rows, float* out, std::size_t n) {
+  if (!is_f32(v, c) || n == 0) return;
+  const std::size_t len = view_len(v);
+  if (max_row(rows, n) < len && len <= view_tile_rows(v)) {
+    simd_gather(out, (const float*)column_tile(v, c, 0), rows, n);
+    return;
+  }
+  auto col = column_rows<float>(v, c);
+  for (std::size_t i = 0; i < n; ++i) out[i] = rows[i] < len ? col[rows[i]] : 0.f;
+}
+
+void column_scatter(ViewId v, ColumnId c, const std::uint32_t* rows, const float* src, std::size_t n) {
+  if (!is_f32(v, c) || n == 0) return;
+  const std::size_t len = view_len(v);
+  std::uint32_t lo = ~0u, hi = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    if (rows[i] < len) { lo = std::min(lo, rows[i]); hi = std::max(hi, rows[i]); }
+  if (lo > hi) return;
+  if (max_row(rows, n) < len && len <= view_tile_rows(v)) {
+    simd_scatter((float*)column_tile(v, c, 0), src, rows, n);
+  } else {
+    auto col = column_rows<float>(v, c);
+    for (std::size_t i = 0; i < n; ++i) if (rows[i] < len) col[rows[i]] = src[i];
+  }
+  mark_changed(v, c, lo, (std::size_t)hi + 1);
+}
+
+float column_sum(ViewId v, ColumnId c) {
+  float s = 0.f;
+  if (!is_f32(v, c)) return s;
+  for_each_tile(v, 0, view_len(v), [&](std::size_t k, std::size_t i0, std::size_t m) {
+    if (const float* p = (const float*)column_tile(v, c, k)) s += simd_sum(p + i0, m);
+  });
+  return s;
+}
+
+float column_min(ViewId v, ColumnId c) {
+  float r = std::numeric_limits<float>::infinity();
+  if (!is_f32(v, c)) return r;
+  for_each_tile(v, 0, view_len(v), [&](std::size_t k, std::size_t i0, std::size_t m) {
+    if (const float* p = (const float*)column_tile(v, c, k)) r = std::min(r, simd_min(p + i0, m));
+  });
+  return r;
+}
+
+float column_max(ViewId v, ColumnId c) {
+  float r = -std::numeric_limits<float>::infinity();
+  if (!is_f32(v, c)) return r;
+  for_each_tile(v, 0, view_len(v), [&](std::size_t k, std::size_t i0, std::size_t m) {
+    if (const float* p = (const float*)column_tile(v, c, k)) r = std::max(r, simd_max(p + i0, m));
+  });
+  return r;
+}
+
+} // namespace dynsoa
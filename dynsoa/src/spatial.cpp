@@ -0,0 +1,110 @@
+// DynSoA Runtime SDK
+
+#include "dynsoa/spatial.h"
+#include "dynsoa/entity_store.h"
+#include "dynsoa/simd.h"
+#include <algorithm>
+#include <cmath>
+
+namespace dynsoa {
+
+static std::int32_t cell_coord(float p, float inv_cell) {
+  return (std::int32_t)std::floor(p * inv_cell);
+}
+
+static std::uint32_t cell_hash(std::int32_t ix, std::int32_t iy, std::int32_t iz, std::uint32_t mask) {
+  return ((std::uint32_t)ix * 73856093u ^ (std::uint32_t)iy * 19349663u ^ (std::uint32_t)iz * 83492791u) & mask;
+}
+
+// Bucket table of at least n entries (load factor <= 1), power of two.
+static void reset_grid(SpatialGrid& g, std::size_t n, float cell_size) {
+  g.cell_size = cell_size > 0 ? cell_size : 1.f;
+  g.inv_cell  = 1.f / g.cell_size;
+  std::size_t buckets = 1;
+  while (buckets < n) buckets <<= 1;
+  g.mask = (std::uint32_t)(buckets - 1);
+  g.cell_start.assign(buckets + 1, 0);
+  g.order.resize(n);
+  g.x.resize(n); g.y.resize(n); g.z.resize(n);
+  g.bucket_of.resize(n);
+}
+
+// Counting sort: histogram buckets, exclusive prefix sum, then scatter rows
+// into their slots. get(row, x, y, z) reads one position.
+template <class Get>
+static void counting_sort(SpatialGrid& g, std::size_t n, Get get) {
+  for (std::size_t r = 0; r < n; ++r) {
+    float x, y, z; get(r, x, y, z);
+    const std::uint32_t b = cell_hash(cell_coord(x, g.inv_cell), cell_coord(y, g.inv_cell),
+                                      cell_coord(z, g.inv_cell), g.mask);
+    g.bucket_of[r] = b;
+    ++g.cell_start[b + 1];
+  }
+  for (std::size_t b = 1; b < g.cell_start.size(); ++b) g.cell_start[b] += g.cell_start[b - 1];
+
+  // Scatter with a moving cursor per bucket, then restore the starts.
+  for (std::size_t r = 0; r < n; ++r) {
+    float x, y, z; get(r, x, y, z);
+    const std::uint32_t s = g.cell_start[g.bucket_of[r]]++;
+    g.order[s] = (std::uint32_t)r;
+    g.x[s] = x; g.y[s] = y; g.z[s] = z;
+  }
+  for (std::size_t b = g.cell_start.size() - 1; b > 0; --b) g.cell_start[b] = g.cell_start[b - 1];
+  g.cell_start[0] = 0;
+}
+
+void grid_build(SpatialGrid& g, const float* x, const float* y, const float* z,
+                std::size_t n, std::size_t stride_bytes, float cell_size) {
+  reset_grid(g, n, cell_size);
+  if (n == 0) return;
+  auto at = [stride_bytes](const float* p, std::size_t r) {
+    return *(const float*)((const unsigned char*)p + r * stride_bytes);
+  };
+  counting_sort(g, n, [&](std::size_t r, float& px, float& py, float& pz) {
+    px = at(x, r); py = at(y, r); pz = at(z, r);
+  });
+}
+
+void grid_build(SpatialGrid& g, ViewId v, ColumnId x, ColumnId y, ColumnId z, float cell_size) {
+  auto px = column_rows<float>(v, x);
+  auto py = column_rows<float>(v, y);
+  auto pz = column_rows<float>(v, z);
+  const std::size_t n = (px && py && pz) ? view_len(v) : 0;
+  reset_grid(g, n, cell_size);
+  if (n == 0) return;
+  counting_sort(g, n, [&](std::size_t r, float& ox, float& oy, float& oz) {
+    ox = px[r]; oy = py[r]; oz = pz[r];
+  });
+}
+
+void grid_gather(const SpatialGrid& g, ViewId v, ColumnId c, std::vector<float>& out) {
+  out.resize(g.size());
+  column_gather(v, c, g.order.data(), out.data(), g.size());
+}
+
+int grid_query(const SpatialGrid& g, float px, float py, float pz, float radius,
+               GridRange* out, int max_out) {
+  if (g.size() == 0) return 0;
+  const std::int32_t x0 = cell_coord(px - radius, g.inv_cell), x1 = cell_coord(px + radius, g.inv_cell);
+  const std::int32_t y0 = cell_coord(py - radius, g.inv_cell), y1 = cell_coord(py + radius, g.inv_cell);
+  const std::int32_t z0 = cell_coord(pz - radius, g.inv_cell), z1 = cell_coord(pz + radius, g.inv_cell);
+
+  int found = 0;
+  for (std::int32_t iz = z0; iz <= z1; ++iz)
+    for (std::int32_t iy = y0; iy <= y1; ++iy)
+      for (std::int32_t ix = x0; ix <= x1; ++ix) {
+        const std::uint32_t b = cell_hash(ix, iy, iz, g.mask);
+        const GridRange r{g.cell_start[b], g.cell_start[b + 1]};
+        if (r.begin == r.end) continue;
+        // Distinct cells can share a bucket; list each bucket once.
+        const int written = std::min(found, max_out);
+        bool seen = false;
+        for (int k = 0; k < written && !seen; ++k) seen = (out[k].begin == r.begin);
+        if (seen) continue;
+        if (found < max_out) out[found] = r;
+        ++found;
+      }
+  return found;
+}
+
+} // namespace dynsoa
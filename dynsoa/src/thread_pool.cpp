@@ -0,0 +1,206 @@
+// DynSoA Runtime SDK
+
+#include "dynsoa/thread_pool.h"
+#include "dynsoa/memory.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dynsoa {
+
+namespace {
+
+struct Job {
+  PoolTaskFn fn;
+  void* arg;
+  std::atomic<std::size_t> remaining{0};
+};
+
+struct Task { Job* job; std::size_t index; };
+
+// Owner pops from the back (most recently pushed, still warm); thieves take
+// from the front, i.e. the far end of the owner's contiguous range.
+struct WorkQueue {
+  std::mutex mu;
+  std::deque<Task> tasks;
+
+  bool pop(Task& t) {
+    std::lock_guard<std::mutex> lk(mu);
+    if (tasks.empty()) return false;
+    t = tasks.back(); tasks.pop_back(); return true;
+  }
+  bool steal(Task& t) {
+    std::lock_guard<std::mutex> lk(mu);
+    if (tasks.empty()) return false;
+    t = tasks.front(); tasks.pop_front(); return true;
+  }
+};
+
+struct Pool {
+  std::vector<std::unique_ptr<WorkQueue>> queues; // [0] belongs to the caller
+  std::vector<std::thread> threads;
+  std::vector<int> node_of_worker; // when striping chunks across NUMA nodes, else empty
+  std::mutex mu;
+  std::condition_variable cv_work, cv_done;
+  std::uint64_t generation = 0;
+  bool stop = false;
+  std::mutex run_mu; // one pool_run at a time
+
+  // Also reached from static destruction when dynsoa_shutdown was skipped;
+  // destroying cv_work under parked workers would block forever.
+  ~Pool() {
+    {
+      std::lock_guard<std::mutex> lk(mu);
+      stop = true;
+    }
+    cv_work.notify_all();
+    for (auto& th : threads) if (th.joinable()) th.join();
+  }
+};
+
+std::mutex g_pool_mu;
+std::unique_ptr<Pool> g_pool;
+thread_local bool t_in_pool = false;
+
+int configured_workers() {
+  if (const char* s = std::getenv("DYNSOA_THREADS")) {
+    int n = std::atoi(s);
+    if (n > 0) return n;
+  }
+  unsigned hc = std::thread::hardware_concurrency();
+  return hc ? (int)hc : 1;
+}
+
+bool next_task(Pool& P, int w, Task& t) {
+  if (P.queues[(std::size_t)w]->pop(t)) return true;
+  const int n = (int)P.queues.size();
+  for (int i = 1; i < n; ++i)
+    if (P.queues[(std::size_t)((w + i) % n)]->steal(t)) return true;
+  return false;
+}
+
+void drain(Pool& P, int w) {
+  Task t;
+  while (next_task(P, w, t)) {
+    t.job->fn(t.job->arg, t.index, w);
+    if (t.job->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      std::lock_guard<std::mutex> lk(P.mu);
+      P.cv_done.notify_all();
+    }
+  }
+}
+
+void worker_main(Pool* P, int w) {
+  t_in_pool = true;
+  if (!P->node_of_worker.empty()) numa_pin_thread(P->node_of_worker[(std::size_t)w]);
+  std::uint64_t seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lk(P->mu);
+      P->cv_work.wait(lk, [&]{ return P->stop || P->generation != seen; });
+      if (P->stop) return;
+      seen = P->generation;
+    }
+    drain(*P, w);
+  }
+}
+
+Pool& pool() {
+  std::lock_guard<std::mutex> lk(g_pool_mu);
+  if (!g_pool) {
+    g_pool.reset(new Pool());
+    const int n = configured_workers();
+    for (int i = 0; i < n; ++i) g_pool->queues.emplace_back(new WorkQueue());
+    // Workers are split into one contiguous group per node and pinned there;
+    // the caller (worker 0) counts towards node 0 but keeps its affinity.
+    if (numa_striping()) {
+      const int nodes = numa_node_count();
+      for (int i = 0; i < n; ++i) g_pool->node_of_worker.push_back(i * nodes / n);
+    }
+    for (int i = 1; i < n; ++i) g_pool->threads.emplace_back(worker_main, g_pool.get(), i);
+  }
+  return *g_pool;
+}
+
+void push_slices(Pool& P, Job& job, const std::vector<std::size_t>& tasks, const std::vector<std::size_t>& workers) {
+  const std::size_t n = workers.size();
+  for (std::size_t i = 0; i < n; ++i) {
+    const std::size_t b = tasks.size() * i / n, e = tasks.size() * (i + 1) / n;
+    WorkQueue& q = *P.queues[workers[i]];
+    std::lock_guard<std::mutex> lk(q.mu);
+    for (std::size_t t = b; t < e; ++t) q.tasks.push_back({&job, tasks[t]});
+  }
+}
+
+// Each node's tasks are sliced over that node's workers; tasks without a
+// usable node are sliced over everyone.
+void seed_by_node(Pool& P, Job& job, std::size_t tasks, const int* task_node) {
+  const std::size_t nodes = (std::size_t)P.node_of_worker.back() + 1;
+  std::vector<std::vector<std::size_t>> workers(nodes + 1), grouped(nodes + 1);
+  for (std::size_t w = 0; w < P.node_of_worker.size(); ++w) {
+    workers[(std::size_t)P.node_of_worker[w]].push_back(w);
+    workers[nodes].push_back(w);
+  }
+  for (std::size_t t = 0; t < tasks; ++t) {
+    const int node = task_node[t];
+    const bool local = node >= 0 && (std::size_t)node < nodes && !workers[(std::size_t)node].empty();
+    grouped[local ? (std::size_t)node : nodes].push_back(t);
+  }
+  for (std::size_t g = 0; g <= nodes; ++g) push_slices(P, job, grouped[g], workers[g]);
+}
+
+} // namespace
+
+int pool_workers() { return (int)pool().queues.size(); }
+
+void pool_run(std::size_t tasks, PoolTaskFn fn, void* arg, const int* task_node) {
+  if (tasks == 0) return;
+  if (t_in_pool) { for (std::size_t t = 0; t < tasks; ++t) fn(arg, t, 0); return; }
+
+  Pool& P = pool();
+  std::lock_guard<std::mutex> run_lk(P.run_mu);
+  Job job; job.fn = fn; job.arg = arg;
+  job.remaining.store(tasks, std::memory_order_relaxed);
+
+  // Seed each worker with a contiguous slice so neighbouring tiles start on
+  // the same core; stealing evens out the imbalance.
+  if (task_node && !P.node_of_worker.empty()) {
+    seed_by_node(P, job, tasks, task_node);
+  } else {
+    const std::size_t n = P.queues.size();
+    for (std::size_t w = 0; w < n; ++w) {
+      const std::size_t b = tasks * w / n, e = tasks * (w + 1) / n;
+      std::lock_guard<std::mutex> lk(P.queues[w]->mu);
+      for (std::size_t t = b; t < e; ++t) P.queues[w]->tasks.push_back({&job, t});
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lk(P.mu);
+    ++P.generation;
+  }
+  P.cv_work.notify_all();
+
+  t_in_pool = true;
+  drain(P, 0);
+  t_in_pool = false;
+
+  std::unique_lock<std::mutex> lk(P.mu);
+  P.cv_done.wait(lk, [&]{ return job.remaining.load(std::memory_order_acquire) == 0; });
+}
+
+void pool_shutdown() {
+  std::unique_ptr<Pool> P;
+  {
+    std::lock_guard<std::mutex> lk(g_pool_mu);
+    P.swap(g_pool);
+  }
+  // ~Pool stops and joins the workers.
+}
+
+} // namespace dynsoa
@@ -3,11 +3,15 @@
 #include "dynsoa/dynsoa.h"
 #include <cstdio>
 #include <cstdlib>
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdint>
 #include <chrono>
 #include <fstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 // We’ll use the C++ namespace-level helpers (view_len, column, current_layout, etc.)
 using namespace dynsoa;
@@ -71,25 +75,28 @@ private:
 // -----------------------------------------------------
 // Boids kernel running *inside* DynSoA
 // -----------------------------------------------------
-static void boids_kernel(ViewId v, const KernelCtx& ctx) {
-  int n = (int)view_len(v);
-  if (n <= 0) return;
-
-  float* px = (float*)column(v, "Position.x");
-  float* py = (float*)column(v, "Position.y");
-  float* pz = (float*)column(v, "Position.z");
+struct BoidColumns {
+  ColumnRows<float> px, py, pz, vx, vy, vz;
+  ColumnRows<std::uint32_t> flags;
+  const SpatialGrid* grid;          // this frame's positions, cell-sorted
+  const float *svx, *svy, *svz;     // this frame's velocities in grid slot order
+};
 
-  float* vx = (float*)column(v, "Velocity.vx");
-  float* vy = (float*)column(v, "Velocity.vy");
-  float* vz = (float*)column(v, "Velocity.vz");
+static const float kNeighborRadius = 3.0f;
+static const float kWorldHalfExtent = 100.0f;
 
-  std::uint32_t* flags = (std::uint32_t*)column(v, "Flags.mask");
+// F is either kAnyBehavior (flags read per row) or the flag pattern shared by
+// a whole partition, in which case every behavior test below is a constant
+// and the loop carries no per-row branches on it.
+constexpr std::uint32_t kAnyBehavior = ~0u;
 
-  if (!px || !py || !pz || !vx || !vy || !vz || !flags) return;
+template <std::uint32_t F>
+static void boids_rows(const BoidColumns& c, int begin, int end, float dt) {
+  const auto& px = c.px; const auto& py = c.py; const auto& pz = c.pz;
+  const auto& vx = c.vx; const auto& vy = c.vy; const auto& vz = c.vz;
+  const SpatialGrid& grid = *c.grid;
 
-  const float dt               = ctx.dt;
-  const float neighbor_radius  = 3.0f;
-  const float neighbor_r2      = neighbor_radius * neighbor_radius;
+  const float neighbor_r2      = kNeighborRadius * kNeighborRadius;
   const float separation_radius = 1.0f;
   const float separation_r2     = separation_radius * separation_radius;
 
@@ -100,24 +107,27 @@ static void boids_kernel(ViewId v, const KernelCtx& ctx) {
   const float max_speed  = 10.0f;
   const float max_speed2 = max_speed * max_speed;
 
-  // Naive O(N^2) + branching → intentionally heavy/divergent to exercise DynSoA.
-  for (int i = 0; i < n; ++i) {
+  // Grid neighbour query + per-row behaviour branches → divergent, but linear in N.
+  for (int i = begin; i < end; ++i) {
     float px_i = px[i];
     float py_i = py[i];
     float pz_i = pz[i];
-    std::uint32_t f = flags[i];
+    const std::uint32_t f = (F == kAnyBehavior) ? c.flags[i] : F;
 
     float sep_x = 0, sep_y = 0, sep_z = 0;
     float ali_x = 0, ali_y = 0, ali_z = 0;
     float coh_x = 0, coh_y = 0, coh_z = 0;
     int count = 0;
 
-    for (int j = 0; j < n; ++j) {
-      if (j == i) continue;
+    GridRange cells[27];
+    const int nc = std::min(grid_query(grid, px_i, py_i, pz_i, kNeighborRadius, cells, 27), 27);
+    for (int q = 0; q < nc; ++q)
+    for (std::uint32_t s = cells[q].begin; s < cells[q].end; ++s) {
+      if (grid.order[s] == (std::uint32_t)i) continue;
 
-      float dx = px[j] - px_i;
-      float dy = py[j] - py_i;
-      float dz = pz[j] - pz_i;
+      float dx = grid.x[s] - px_i;
+      float dy = grid.y[s] - py_i;
+      float dz = grid.z[s] - pz_i;
       float dist2 = dx*dx + dy*dy + dz*dz;
       if (dist2 > neighbor_r2) continue;
       ++count;
@@ -129,11 +139,11 @@ static void boids_kernel(ViewId v, const KernelCtx& ctx) {
       }
 
       if (f & BEHAVIOR_ALIGN) {
-        ali_x += vx[j]; ali_y += vy[j]; ali_z += vz[j];
+        ali_x += c.svx[s]; ali_y += c.svy[s]; ali_z += c.svz[s];
       }
 
       if (f & BEHAVIOR_COHERE) {
-        coh_x += px[j]; coh_y += py[j]; coh_z += pz[j];
+        coh_x += grid.x[s]; coh_y += grid.y[s]; coh_z += grid.z[s];
       }
     }
 
@@ -192,6 +202,78 @@ static void boids_kernel(ViewId v, const KernelCtx& ctx) {
   }
 }
 
+using BoidRowsFn = void (*)(const BoidColumns&, int, int, float);
+
+template <std::size_t... F>
+static std::array<BoidRowsFn, sizeof...(F)> boid_specializations(std::index_sequence<F...>) {
+  return {&boids_rows<(std::uint32_t)F>...};
+}
+
+static void boids_kernel(ViewId v, const KernelCtx& ctx) {
+  int n = (int)view_len(v);
+  if (n <= 0) return;
+
+  const ColumnId cpx = column_id(v, "Position.x"), cpy = column_id(v, "Position.y"), cpz = column_id(v, "Position.z");
+  const ColumnId cvx = column_id(v, "Velocity.vx"), cvy = column_id(v, "Velocity.vy"), cvz = column_id(v, "Velocity.vz");
+
+  // Neighbours are read from a snapshot of the frame's start, rebuilt here.
+  static SpatialGrid grid;
+  static std::vector<float> svx, svy, svz;
+  grid_build(grid, v, cpx, cpy, cpz, kNeighborRadius);
+  grid_gather(grid, v, cvx, svx);
+  grid_gather(grid, v, cvy, svy);
+  grid_gather(grid, v, cvz, svz);
+
+  // Tiled row access: valid in SoA and after an AoSoA retile.
+  BoidColumns c{
+    column_rows<float>(v, cpx),
+    column_rows<float>(v, cpy),
+    column_rows<float>(v, cpz),
+    column_rows<float>(v, cvx),
+    column_rows<float>(v, cvy),
+    column_rows<float>(v, cvz),
+    column_rows<std::uint32_t>(v, column_id(v, "Flags.mask")),
+    &grid, svx.data(), svy.data(), svz.data(),
+  };
+  if (!c.px || !c.py || !c.pz || !c.vx || !c.vy || !c.vz || !c.flags) return;
+
+  // After PARTITION_BY_MASK every group shares one flag pattern; run the loop
+  // specialized for it. Unpartitioned views take the per-row path.
+  static const auto specialized = boid_specializations(std::make_index_sequence<16>{});
+  RowPartition groups[16];
+  const int g = view_partitions(v, groups, 16);
+  if (g == 0 || g > 16) { boids_rows<kAnyBehavior>(c, 0, n, ctx.dt); return; }
+  for (int k = 0; k < g; ++k) {
+    BoidRowsFn fn = groups[k].key < 16 ? specialized[groups[k].key] : &boids_rows<kAnyBehavior>;
+    fn(c, (int)groups[k].begin, (int)groups[k].end, ctx.dt);
+  }
+}
+
+struct BoidInitCols { ColumnId px, py, pz, flags; };
+
+// Deterministic value in [-1, 1) for (row, salt).
+static float hash_unit(std::size_t row, std::uint32_t salt) {
+  std::uint32_t h = (std::uint32_t)row * 2654435761u ^ salt * 0x9e3779b9u;
+  h ^= h >> 16; h *= 0x85ebca6bu; h ^= h >> 13; h *= 0xc2b2ae35u; h ^= h >> 16;
+  return (float)(h >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+// Boids spread over the world cube (so the grid has real neighbourhoods), with
+// mixed behaviors so the per-row branches actually diverge.
+static void init_boids(std::size_t first, std::size_t count, const ColumnSet* cols, void* user) {
+  const BoidInitCols& ids = *(const BoidInitCols*)user;
+  float* px = cols->get<float>(ids.px);
+  float* py = cols->get<float>(ids.py);
+  float* pz = cols->get<float>(ids.pz);
+  std::uint32_t* flags = cols->get<std::uint32_t>(ids.flags);
+  for (std::size_t i = 0; i < count; ++i) {
+    px[i] = hash_unit(first + i, 1) * kWorldHalfExtent;
+    py[i] = hash_unit(first + i, 2) * kWorldHalfExtent;
+    pz[i] = hash_unit(first + i, 3) * kWorldHalfExtent;
+    flags[i] = (std::uint32_t)(((first + i) * 2654435761u) >> 7) & 0xfu;
+  }
+}
+
 // -----------------------------------------------------
 // main()
 // -----------------------------------------------------
@@ -233,11 +315,20 @@ int main() {
   ArchetypeId arch    = dynsoa_define_archetype("Boid", comps, 3);
 
   // ---------- Spawn entities ----------
-  const long long default_entities = 500000;
+  const long long default_entities = 200000;
   std::size_t num_entities = (std::size_t)env_ll("DYNSOA_ENTITIES", default_entities);
 
-  dynsoa_spawn(arch, num_entities, nullptr);
   ViewId view = dynsoa_make_view(arch);
+  BoidInitCols init_cols{dynsoa_column_id(view, "Position.x"), dynsoa_column_id(view, "Position.y"),
+                         dynsoa_column_id(view, "Position.z"), dynsoa_column_id(view, "Flags.mask")};
+  dynsoa_spawn_bulk(arch, num_entities, init_boids, &init_cols);
+  // Group rows by behavior so boids_kernel runs one specialized loop per group.
+  // DYNSOA_BOIDS_PARTITION=0 keeps the per-row branches, for measuring the gain;
+  // both modes share the grid neighbour query.
+  const bool partitioned = env_int("DYNSOA_BOIDS_PARTITION", 1) != 0;
+  if (partitioned) dynsoa_partition_by_mask(view, "Flags.mask", 0);
+  std::printf("Boids step: %s\n", partitioned ? "partitioned by Flags.mask (specialized loop per group)"
+                                               : "unpartitioned (per-row behavior branches)");
 
   // ---------- Optional: keep internal metrics CSV separate ----------
   // This is the low-level internal metrics (time_us, etc.) from dynsoa itself.
@@ -247,7 +338,7 @@ int main() {
   dynsoa_set_policy("{}");
 
   // ---------- Simulation params ----------
-  int frames  = env_int("DYNSOA_FRAMES", 1000);
+  int frames  = env_int("DYNSOA_FRAMES", 300);
   float dt    = 0.016f;             // ~60 FPS
   KernelCtx ctx{dt, cfg.aosoa_tile};
 
@@ -270,7 +361,7 @@ int main() {
     int retile_flag = (layout_after != layout_before) ? 1 : 0;
 
     writer.write_row(
-      "DynSoA",
+      partitioned ? "DynSoA-partitioned" : "DynSoA",
       f,
       num_entities,
       ms,
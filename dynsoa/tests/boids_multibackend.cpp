@@ -128,6 +128,12 @@ static void step_oop(std::vector<EntityOOP>& ents,
   float dt            = params.dt;
   float max_speed2    = params.max_speed * params.max_speed;
 
+  // Bucket positions by neighbor_radius so each boid only visits nearby cells.
+  static SpatialGrid grid;
+  if (N == 0) return;
+  grid_build(grid, &ents[0].position.x, &ents[0].position.y, &ents[0].position.z,
+             N, sizeof(EntityOOP), params.neighbor_radius);
+
   // compute accelerations
   std::vector<Vec3> accel(N, Vec3{0,0,0});
 
@@ -141,7 +147,11 @@ static void step_oop(std::vector<EntityOOP>& ents,
     Vec3 sep{0,0,0}, ali{0,0,0}, coh{0,0,0};
     int count = 0;
 
-    for (std::size_t j = 0; j < N; ++j) {
+    GridRange cells[27];
+    const int nc = std::min(grid_query(grid, px, py, pz, params.neighbor_radius, cells, 27), 27);
+    for (int c = 0; c < nc; ++c)
+    for (std::uint32_t s = cells[c].begin; s < cells[c].end; ++s) {
+      const std::size_t j = grid.order[s];
       if (j == i) continue;
       const auto& other = ents[j];
       float dx = other.position.x - px;
@@ -296,6 +306,16 @@ static void step_soa(SoABoids& b,
 
   std::vector<float> ax(N,0.0f), ay(N,0.0f), az(N,0.0f);
 
+  // Cell-sorted positions and velocities: the neighbor loop reads them contiguously.
+  static SpatialGrid grid;
+  static std::vector<float> svx, svy, svz;
+  grid_build(grid, b.px.data(), b.py.data(), b.pz.data(), N, sizeof(float), params.neighbor_radius);
+  svx.resize(N); svy.resize(N); svz.resize(N);
+  for (std::size_t s = 0; s < N; ++s) {
+    const std::uint32_t r = grid.order[s];
+    svx[s] = b.vx[r]; svy[s] = b.vy[r]; svz[s] = b.vz[r];
+  }
+
   for (std::size_t i = 0; i < N; ++i) {
     float px_i = b.px[i];
     float py_i = b.py[i];
@@ -307,11 +327,14 @@ static void step_soa(SoABoids& b,
     float coh_x=0, coh_y=0, coh_z=0;
     int count = 0;
 
-    for (std::size_t j = 0; j < N; ++j) {
-      if (j == i) continue;
-      float dx = b.px[j] - px_i;
-      float dy = b.py[j] - py_i;
-      float dz = b.pz[j] - pz_i;
+    GridRange cells[27];
+    const int nc = std::min(grid_query(grid, px_i, py_i, pz_i, params.neighbor_radius, cells, 27), 27);
+    for (int c = 0; c < nc; ++c)
+    for (std::uint32_t s = cells[c].begin; s < cells[c].end; ++s) {
+      if (grid.order[s] == i) continue;
+      float dx = grid.x[s] - px_i;
+      float dy = grid.y[s] - py_i;
+      float dz = grid.z[s] - pz_i;
       float dist2 = dx*dx + dy*dy + dz*dz;
       if (dist2 > neighbor_r2) continue;
       ++count;
@@ -322,10 +345,10 @@ static void step_soa(SoABoids& b,
         }
       }
       if (f & BEHAVIOR_ALIGN) {
-        ali_x += b.vx[j]; ali_y += b.vy[j]; ali_z += b.vz[j];
+        ali_x += svx[s]; ali_y += svy[s]; ali_z += svz[s];
       }
       if (f & BEHAVIOR_COHERE) {
-        coh_x += b.px[j]; coh_y += b.py[j]; coh_z += b.pz[j];
+        coh_x += grid.x[s]; coh_y += grid.y[s]; coh_z += grid.z[s];
       }
     }
 
@@ -406,24 +429,61 @@ static void run_soa_backend(CsvWriter& writer,
 // DynSoA backend
 // =========================
 
-static void boids_kernel_dynsoa(ViewId v, const KernelCtx& ctx) {
-  int n = (int)view_len(v);
-  if (n <= 0) return;
+// Position and Velocity are double-buffered: the step reads frame N through
+// the front columns and the grid snapshot, and writes frame N+1 only through
+// the back columns, so rows are independent and run in parallel.
+// dynsoa_end_frame swaps the buffers.
+struct BoidsDynSoAFrame {
+  ColumnId cpx, cpy, cpz, cvx, cvy, cvz, cflags;
+  ColumnId npx, npy, npz, nvx, nvy, nvz;
+  SpatialGrid grid;
+  std::vector<float> svx, svy, svz;
+};
+static BoidsDynSoAFrame g_boids;
 
-  float* px = (float*)column(v, "Position.x");
-  float* py = (float*)column(v, "Position.y");
-  float* pz = (float*)column(v, "Position.z");
+static const float kNeighborRadius = 3.0f;
 
-  float* vx = (float*)column(v, "Velocity.vx");
-  float* vy = (float*)column(v, "Velocity.vy");
-  float* vz = (float*)column(v, "Velocity.vz");
+static void boids_setup_dynsoa(ViewId v) {
+  BoidsDynSoAFrame& B = g_boids;
+  B.cpx = column_id(v, "Position.x"); B.cpy = column_id(v, "Position.y"); B.cpz = column_id(v, "Position.z");
+  B.cvx = column_id(v, "Velocity.vx"); B.cvy = column_id(v, "Velocity.vy"); B.cvz = column_id(v, "Velocity.vz");
+  B.cflags = column_id(v, "Flags.mask");
+  B.npx = set_double_buffered(v, B.cpx); B.npy = set_double_buffered(v, B.cpy); B.npz = set_double_buffered(v, B.cpz);
+  B.nvx = set_double_buffered(v, B.cvx); B.nvy = set_double_buffered(v, B.cvy); B.nvz = set_double_buffered(v, B.cvz);
+}
 
-  std::uint32_t* flags = (std::uint32_t*)column(v, "Flags.mask");
-  if (!px || !py || !pz || !vx || !vy || !vz || !flags) return;
+// Serial pre-pass: this frame's cell-sorted neighbour snapshot.
+static void boids_grid_dynsoa(ViewId v, const KernelCtx&) {
+  BoidsDynSoAFrame& B = g_boids;
+  grid_build(B.grid, v, B.cpx, B.cpy, B.cpz, kNeighborRadius);
+  grid_gather(B.grid, v, B.cvx, B.svx);
+  grid_gather(B.grid, v, B.cvy, B.svy);
+  grid_gather(B.grid, v, B.cvz, B.svz);
+}
+
+static void boids_step_dynsoa(ViewId v, const KernelCtx& ctx, std::size_t begin, std::size_t end) {
+  const BoidsDynSoAFrame& B = g_boids;
+  const SpatialGrid& grid = B.grid;
+
+  // Tiled row access: valid in SoA and after an AoSoA retile.
+  auto px = column_rows<float>(v, B.cpx);
+  auto py = column_rows<float>(v, B.cpy);
+  auto pz = column_rows<float>(v, B.cpz);
+  auto vx = column_rows<float>(v, B.cvx);
+  auto vy = column_rows<float>(v, B.cvy);
+  auto vz = column_rows<float>(v, B.cvz);
+  auto flags = column_rows<std::uint32_t>(v, B.cflags);
+  auto vx_next = column_rows<float>(v, B.nvx);
+  auto vy_next = column_rows<float>(v, B.nvy);
+  auto vz_next = column_rows<float>(v, B.nvz);
+  auto px_next = column_rows<float>(v, B.npx);
+  auto py_next = column_rows<float>(v, B.npy);
+  auto pz_next = column_rows<float>(v, B.npz);
+  if (!px || !py || !pz || !vx || !vy || !vz || !flags ||
+      !px_next || !py_next || !pz_next || !vx_next || !vy_next || !vz_next) return;
 
   const float dt               = ctx.dt;
-  const float neighbor_radius  = 3.0f;
-  const float neighbor_r2      = neighbor_radius * neighbor_radius;
+  const float neighbor_r2      = kNeighborRadius * kNeighborRadius;
   const float separation_radius= 1.0f;
   const float separation_r2    = separation_radius * separation_radius;
 
@@ -432,9 +492,8 @@ static void boids_kernel_dynsoa(ViewId v, const KernelCtx& ctx) {
   const float cohesion_weight  = 1.0f;
 
   const float max_speed        = 10.0f;
-  const float max_speed2       = max_speed * max_speed;
 
-  for (int i = 0; i < n; ++i) {
+  for (std::size_t i = begin; i < end; ++i) {
     float px_i = px[i], py_i = py[i], pz_i = pz[i];
     std::uint32_t f = flags[i];
 
@@ -443,11 +502,14 @@ static void boids_kernel_dynsoa(ViewId v, const KernelCtx& ctx) {
     float coh_x=0, coh_y=0, coh_z=0;
     int count = 0;
 
-    for (int j = 0; j < n; ++j) {
-      if (j == i) continue;
-      float dx = px[j] - px_i;
-      float dy = py[j] - py_i;
-      float dz = pz[j] - pz_i;
+    GridRange cells[27];
+    const int nc = std::min(grid_query(grid, px_i, py_i, pz_i, kNeighborRadius, cells, 27), 27);
+    for (int c = 0; c < nc; ++c)
+    for (std::uint32_t s = cells[c].begin; s < cells[c].end; ++s) {
+      if (grid.order[s] == (std::uint32_t)i) continue;
+      float dx = grid.x[s] - px_i;
+      float dy = grid.y[s] - py_i;
+      float dz = grid.z[s] - pz_i;
       float dist2 = dx*dx + dy*dy + dz*dz;
       if (dist2 > neighbor_r2) continue;
       ++count;
@@ -458,10 +520,10 @@ static void boids_kernel_dynsoa(ViewId v, const KernelCtx& ctx) {
         }
       }
       if (f & BEHAVIOR_ALIGN) {
-        ali_x += vx[j]; ali_y += vy[j]; ali_z += vz[j];
+        ali_x += B.svx[s]; ali_y += B.svy[s]; ali_z += B.svz[s];
       }
       if (f & BEHAVIOR_COHERE) {
-        coh_x += px[j]; coh_y += py[j]; coh_z += pz[j];
+        coh_x += grid.x[s]; coh_y += grid.y[s]; coh_z += grid.z[s];
       }
     }
 
@@ -493,24 +555,63 @@ static void boids_kernel_dynsoa(ViewId v, const KernelCtx& ctx) {
       ax *= 1.5f; ay *= 1.5f; az *= 1.5f;
     }
 
-    float vx_i = vx[i] + ax * dt;
-    float vy_i = vy[i] + ay * dt;
-    float vz_i = vz[i] + az * dt;
-    float s2 = vx_i*vx_i + vy_i*vy_i + vz_i*vz_i;
-    if (s2 > max_speed2) {
-      float inv_len = 1.0f / std::sqrt(s2);
-      vx_i *= max_speed * inv_len;
-      vy_i *= max_speed * inv_len;
-      vz_i *= max_speed * inv_len;
-    }
+    vx_next[i] = vx[i] + ax * dt;
+    vy_next[i] = vy[i] + ay * dt;
+    vz_next[i] = vz[i] + az * dt;
+    px_next[i] = px_i;
+    py_next[i] = py_i;
+    pz_next[i] = pz_i;
+  }
+
+  // Speed clamp and integration as vectorized passes over this range's
+  // back buffers.
+  column_clamp_length(v, B.nvx, B.nvy, B.nvz, max_speed, begin, end);
+  column_axpy(v, B.npx, B.nvx, dt, begin, end);
+  column_axpy(v, B.npy, B.nvy, dt, begin, end);
+  column_axpy(v, B.npz, B.nvz, dt, begin, end);
+}
+
+// Whole view on the calling thread, like the OOP and SoA backends.
+static void boids_step_dynsoa_serial(ViewId v, const KernelCtx& ctx) {
+  boids_step_dynsoa(v, ctx, 0, dynsoa_view_len(v));
+}
+
+// Same distribution and seed as init_soa, written through the view's columns.
+static void init_dynsoa(ViewId v,
+                        const BoidsParams& params,
+                        unsigned int seed) {
+  auto px = column_rows<float>(v, column_id(v, "Position.x"));
+  auto py = column_rows<float>(v, column_id(v, "Position.y"));
+  auto pz = column_rows<float>(v, column_id(v, "Position.z"));
+  auto vx = column_rows<float>(v, column_id(v, "Velocity.vx"));
+  auto vy = column_rows<float>(v, column_id(v, "Velocity.vy"));
+  auto vz = column_rows<float>(v, column_id(v, "Velocity.vz"));
+  auto flags = column_rows<std::uint32_t>(v, column_id(v, "Flags.mask"));
+  if (!px || !py || !pz || !vx || !vy || !vz || !flags) return;
+
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> posd(-params.world_half_extent,
+                                             params.world_half_extent);
+  std::uniform_real_distribution<float> veld(-1.0f, 1.0f);
+  std::uniform_int_distribution<std::uint32_t> bitsd;
 
-    vx[i] = vx_i;
-    vy[i] = vy_i;
-    vz[i] = vz_i;
+  const std::size_t N = view_len(v);
+  for (std::size_t i = 0; i < N; ++i) {
+    px[i] = posd(rng);
+    py[i] = posd(rng);
+    pz[i] = posd(rng);
+
+    vx[i] = veld(rng);
+    vy[i] = veld(rng);
+    vz[i] = veld(rng);
 
-    px[i] = px_i + vx_i * dt;
-    py[i] = py_i + vy_i * dt;
-    pz[i] = pz_i + vz_i * dt;
+    std::uint32_t bits = bitsd(rng);
+    std::uint32_t f = 0;
+    if (bits & 1) f |= BEHAVIOR_AVOID;
+    if (bits & 2) f |= BEHAVIOR_ALIGN;
+    if (bits & 4) f |= BEHAVIOR_COHERE;
+    if (bits & 8) f |= BEHAVIOR_HIGH_ENERGY;
+    flags[i] = f;
   }
 }
 
@@ -551,6 +652,8 @@ static void run_dynsoa_backend(CsvWriter& writer,
 
   dynsoa_spawn(arch, num_entities, nullptr);
   ViewId view = dynsoa_make_view(arch);
+  init_dynsoa(view, params, /*seed=*/12345);
+  boids_setup_dynsoa(view);
 
   // internal metrics CSV if you want it
   dynsoa_metrics_enable_csv("metrics_internal_dynsoa.csv");
@@ -558,14 +661,23 @@ static void run_dynsoa_backend(CsvWriter& writer,
 
   KernelCtx ctx{params.dt, cfg.aosoa_tile};
 
+  // The other backends are single-threaded, so the step runs serially too
+  // unless DYNSOA_BOIDS_PARALLEL=1; parallel rows get their own backend label.
+  const bool parallel = env_int("DYNSOA_BOIDS_PARALLEL", 0) != 0;
+  const char* label = parallel ? "DynSoA-parallel" : "DynSoA";
+  std::printf("DynSoA step: %s\n", parallel ? "parallel (DYNSOA_BOIDS_PARALLEL=1), not like-for-like with OOP/SoA"
+                                               : "single-threaded (DYNSOA_BOIDS_PARALLEL=1 to use the pool)");
+
   for (int f = 0; f < frames; ++f) {
     auto t0 = std::chrono::high_resolution_clock::now();
     dynsoa_begin_frame();
-    dynsoa_run_kernel("boids_step", boids_kernel_dynsoa, view, &ctx);
+    dynsoa_run_kernel("boids_grid", boids_grid_dynsoa, view, &ctx);
+    if (parallel) dynsoa_run_kernel_parallel("boids_step", boids_step_dynsoa, view, &ctx);
+    else          dynsoa_run_kernel("boids_step", boids_step_dynsoa_serial, view, &ctx);
     dynsoa_end_frame();
     auto t1 = std::chrono::high_resolution_clock::now();
     double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
-    writer.write_row("DynSoA", f, num_entities, ms);
+    writer.write_row(label, f, num_entities, ms);
   }
 
   std::printf("DynSoA backend done.\n");
@@ -14,6 +14,7 @@
 #include <sstream>
 
 #include "dynsoa/dynsoa.h"
+#include "dynsoa/typed_view.h"
 
 using namespace dynsoa;
 
@@ -21,39 +22,76 @@ struct Stats {
   double mean_us=0, p95_us=0, p99_us=0, tail_ratio=0;
 };
 
+// Column handles, resolved once after the view is created.
+static ColumnId g_px = kInvalidColumn;
+static ColumnId g_vx = kInvalidColumn;
+
+// Typed bindings for the smoke archetype's components.
+struct PositionC {
+  using scalar = float;
+  static constexpr const char* name = "Position";
+  static constexpr const char* fields[] = {"x"};
+};
+struct VelocityC {
+  using scalar = float;
+  static constexpr const char* name = "Velocity";
+  static constexpr const char* fields[] = {"vx"};
+};
+
 // ---------------- Kernels ----------------
 
+// Kernels walk the view tile by tile so they are valid in SoA (one tile) and AoSoA.
 static void k_physics(ViewId v, const KernelCtx& ctx) {
-  int n = (int)view_len(v);
-  float* px = (float*)column(v, "Position.x");
-  float* vx = (float*)column(v, "Velocity.vx");
-  if (!px || !vx) return;
   volatile float guard = 0.f;
-  for (int i=0;i<n;++i) {
-    float val = px[i] + vx[i]*ctx.dt;
-    px[i] = val;
-    guard += val * 1e-9f;
-  }
+  TypedView<PositionC, const VelocityC> tv(v);
+  tv.for_each_tile([&](auto n, auto pos, auto vel) {
+    restrict_ptr<float> px = pos[0];
+    restrict_ptr<const float> vx = vel[0];
+    float g = 0.f;
+    for (std::size_t i=0;i<n;++i) {
+      const float val = px[i] + vx[i]*ctx.dt;
+      px[i] = val;
+      g += val * 1e-9f;
+    }
+    guard = guard + g;
+  });
   if (guard < -1e30f) std::cerr << ""; // keep compiler honest
 }
 
+// Range form of k_physics for dynsoa_run_kernel_parallel; ranges are tile-aligned.
+static void k_physics_range(ViewId v, const KernelCtx& ctx, std::size_t b, std::size_t e) {
+  const std::size_t T = view_tile_rows(v);
+  for (std::size_t r=b; r<e; ) {
+    const std::size_t k = r / T, i0 = r - k*T, m = std::min(T - i0, e - r);
+    float* px = (float*)column_tile(v, g_px, k);
+    float* vx = (float*)column_tile(v, g_vx, k);
+    if (!px || !vx) return;
+    simd_axpy(px + i0, vx + i0, ctx.dt, m);
+    r += m;
+  }
+}
+
 static void k_branchy(ViewId v, const KernelCtx& ctx) {
-  int n = (int)view_len(v);
-  float* px = (float*)column(v, "Position.x");
-  float* vx = (float*)column(v, "Velocity.vx");
-  if (!px || !vx) return;
-  for (int i=0;i<n;++i) {
-    float x = px[i];
-    if (x >  1000.0f) px[i] = x * 0.97f;
-    else if (x < -1000.0f) px[i] = x * 1.03f;
-    else px[i] = x + vx[i]*0.001f;
+  const std::size_t n = view_len(v);
+  const std::size_t T = view_tile_rows(v);
+  for (std::size_t b=0, k=0; b<n; b+=T, ++k) {
+    float* px = (float*)column_tile(v, g_px, k);
+    float* vx = (float*)column_tile(v, g_vx, k);
+    if (!px || !vx) return;
+    const std::size_t m = std::min(T, n - b);
+    for (std::size_t i=0;i<m;++i) {
+      float x = px[i];
+      if (x >  1000.0f) px[i] = x * 0.97f;
+      else if (x < -1000.0f) px[i] = x * 1.03f;
+      else px[i] = x + vx[i]*0.001f;
+    }
   }
 }
 
 static void k_scatter(ViewId v, const KernelCtx& ctx) {
   int n = (int)view_len(v);
-  float* px = (float*)column(v, "Position.x");
-  float* vx = (float*)column(v, "Velocity.vx");
+  auto px = column_rows<float>(v, g_px);
+  auto vx = column_rows<float>(v, g_vx);
   if (!px || !vx || n<=0) return;
   const int stride = 13;
   for (int i=0;i<n;++i) {
@@ -64,7 +102,7 @@ static void k_scatter(ViewId v, const KernelCtx& ctx) {
 
 static void k_block(ViewId v, const KernelCtx& ctx) {
   const char* comps[] = {"Position.x","Velocity.vx"};
-  MatrixBlock mb = acquire_matrix_block(v, comps, 2, /*block_rows*/ 2048, /*offset_rows*/ 0);
+  MatrixBlock mb = acquire_matrix_block(v, comps, 2, /*block_rows*/ 2048, /*offset_rows*/ 0, kMatrixBlockZeroCopy);
   if (!mb.data || mb.rows <= 0 || mb.cols < 2) return;
   float* P = mb.data + 0*mb.leading_dim;
   float* V = mb.data + 1*mb.leading_dim;
@@ -76,32 +114,29 @@ static void k_block(ViewId v, const KernelCtx& ctx) {
 
 // ---------------- Helpers ----------------
 
-static void init_entities(ViewId v) {
-  int n = (int)view_len(v);
-  float* px = (float*)column(v, "Position.x");
-  float* vx = (float*)column(v, "Velocity.vx");
-  if (!px || !vx) {
-    std::cerr << "[init] null columns (px=" << (void*)px << " vx=" << (void*)vx << ")\n";
-    return;
-  }
-  for (int i = 0; i < n; ++i) {
-    px[i] = (float)i * 0.001f;
-    vx[i] = 1.0f + (float)((i % 7) - 3) * 0.05f;
+static void init_entities(std::size_t first, std::size_t n, const ColumnSet* cols, void*) {
+  float* px = cols->get<float>(g_px);
+  float* vx = cols->get<float>(g_vx);
+  for (std::size_t i = 0; i < n; ++i) {
+    const std::size_t row = first + i;
+    px[i] = (float)row * 0.001f;
+    vx[i] = 1.0f + (float)((int)(row % 7) - 3) * 0.05f;
   }
 }
 
 struct MixStep {
-  enum Kind { Physics, Branchy, Scatter, Block } kind;
+  enum Kind { Physics, PhysicsMT, Branchy, Scatter, Block } kind;
   int period; // 1 = every frame; N = every N frames (used for Block)
 };
 
 static std::vector<MixStep> parse_mix(const std::string& mix) {
-  // Example: "physics,branchy,scatter,block/8"
+  // Example: "physics,branchy,scatter,block/8" ("physics_mt" runs on the worker pool)
   std::vector<MixStep> out;
   std::stringstream ss(mix);
   std::string tok;
   while (std::getline(ss, tok, ',')) {
     if (tok == "physics") out.push_back({MixStep::Physics, 1});
+    else if (tok == "physics_mt") out.push_back({MixStep::PhysicsMT, 1});
     else if (tok == "branchy") out.push_back({MixStep::Branchy, 1});
     else if (tok == "scatter") out.push_back({MixStep::Scatter, 1});
     else if (tok.rfind("block",0)==0) {
@@ -126,6 +161,7 @@ static void run_mix_for_frame(ViewId v, const KernelCtx& ctx, const std::vector<
   for (const auto& m : mix) {
     switch (m.kind) {
       case MixStep::Physics: dynsoa_run_kernel("k_physics", k_physics, v, &ctx); break;
+      case MixStep::PhysicsMT: dynsoa_run_kernel_parallel("k_physics_mt", k_physics_range, v, &ctx); break;
       case MixStep::Branchy: dynsoa_run_kernel("k_branchy", k_branchy, v, &ctx); break;
       case MixStep::Scatter: dynsoa_run_kernel("k_scatter", k_scatter, v, &ctx); break;
       case MixStep::Block:
@@ -247,12 +283,21 @@ int main(int argc, char** argv) {
   ArchetypeId arch = define_archetype("Particle", comps, 2);
 
   // Storage + view
-  spawn(arch, (std::size_t)rc.entities, nullptr);
   ViewId v = make_view(arch);
-  if ((long long)view_len(v) <= 0) {
-    v = make_view(arch);
+  g_px = column_id(v, "Position.x");
+  g_vx = column_id(v, "Velocity.vx");
+  if (g_px == kInvalidColumn || g_vx == kInvalidColumn) {
+    std::cerr << "[init] missing columns\n";
+    return 1;
+  }
+  spawn_bulk(arch, (std::size_t)rc.entities, init_entities);
+
+  // The SIMD path picked for this host must agree with DYNSOA_SIMD=scalar.
+  if (!simd_matches_scalar()) {
+    std::cerr << "[simd] " << simd_level_name(simd_level()) << " element-wise results differ from scalar\n";
+    return 1;
   }
-  init_entities(v);
+  std::cout << "[simd] " << simd_level_name(simd_level()) << " element-wise results match scalar\n";
 
   // Baseline: force SoA, disable adaptive
   retile_to_soa(v);
@@ -8,20 +8,26 @@ namespace DynSoA
 {
     public enum Device : byte { CPU = 0, GPU = 1 }
     public enum ScalarType : byte { F32=0, I32=1, U32=2, F64=3, I64=4 }
+    public enum NumaPolicy : byte { FirstTouch=0, Interleave=1, Bind=2 }
+    public enum HugePages : byte { Off=0, Transparent=1, Explicit=2 }
 
     [StructLayout(LayoutKind.Sequential)]
-    public struct Config { public Device device; public int aosoa_tile, matrix_block, max_retile_us; [MarshalAs(UnmanagedType.I1)] public bool scheduler_enabled; }
+    public struct Config { public Device device; public int aosoa_tile, matrix_block, max_retile_us; [MarshalAs(UnmanagedType.I1)] public bool scheduler_enabled; public int column_align; public NumaPolicy numa; public int numa_node; public HugePages huge_pages; }
 
     [StructLayout(LayoutKind.Sequential)] public struct Field { public IntPtr name; public ScalarType type; }
     [StructLayout(LayoutKind.Sequential)] public struct Component { public IntPtr name; public IntPtr fields; public int field_count; }
     [StructLayout(LayoutKind.Sequential)] public struct KernelCtx { public float dt; public int tile; }
-    [StructLayout(LayoutKind.Sequential)] public struct MatrixBlock { public IntPtr data; public int rows, cols, leading_dim; public UIntPtr bytes, offset; }
+    [StructLayout(LayoutKind.Sequential)] public struct MatrixBlock { public IntPtr data; public int rows, cols, leading_dim; public UIntPtr bytes, offset; public IntPtr header; public uint flags; }
+    [StructLayout(LayoutKind.Sequential)] public struct GridRange { public uint begin, end; }
+    [StructLayout(LayoutKind.Sequential)] public struct RowPartition { public uint key, begin, end; }
+    [StructLayout(LayoutKind.Sequential)] public struct ColumnSet { public ulong view; public UIntPtr first_row, count, column_count; public IntPtr columns; }
 
     [StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
     public struct Sample {
         public IntPtr kernel; public ulong view;
         public float warp_eff, branch_div, mem_coalesce, l2_miss_rate;
         public uint time_us, p95_tile_us, p99_tile_us;
+        public ulong cpu_instructions, cpu_branch_misses, cpu_cache_misses, cpu_llc_misses;
     }
 
     public static class Native
@@ -35,23 +41,70 @@ namespace DynSoA
         [DllImport(LIB, CharSet=CharSet.Ansi)] public static extern ulong dynsoa_define_archetype(string name, string[] comps, int count);
 
         [DllImport(LIB)] public static extern IntPtr dynsoa_spawn(ulong arch, UIntPtr count, IntPtr init_fn);
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate void SpawnInitFn(UIntPtr firstRow, UIntPtr count, ref ColumnSet cols, IntPtr user);
+        [DllImport(LIB)] public static extern UIntPtr dynsoa_spawn_bulk(ulong arch, UIntPtr count, SpawnInitFn init_fn, IntPtr user);
         [DllImport(LIB)] public static extern ulong dynsoa_make_view(ulong arch);
         [DllImport(LIB)] public static extern UIntPtr dynsoa_view_len(ulong view);
         [DllImport(LIB, CharSet=CharSet.Ansi)] public static extern IntPtr dynsoa_column(ulong view, string path);
+        [DllImport(LIB, CharSet=CharSet.Ansi)] public static extern int dynsoa_column_id(ulong view, string path);
+        [DllImport(LIB)] public static extern IntPtr dynsoa_column_ptr(ulong view, int column);
+        [DllImport(LIB)] public static extern UIntPtr dynsoa_view_tile_rows(ulong view);
+        [DllImport(LIB)] public static extern IntPtr dynsoa_column_tile(ulong view, int column, UIntPtr tile);
+        [DllImport(LIB)] public static extern UIntPtr dynsoa_view_capacity(ulong view);
+        [DllImport(LIB)] public static extern UIntPtr dynsoa_view_padded_len(ulong view);
+        [DllImport(LIB)] public static extern int dynsoa_set_double_buffered(ulong view, int column);
+        [DllImport(LIB)] public static extern int dynsoa_column_next(ulong view, int column);
+        [DllImport(LIB)] public static extern int dynsoa_numa_node_count();
+        [DllImport(LIB)] public static extern int dynsoa_view_row_node(ulong view, UIntPtr row);
+        [DllImport(LIB)] public static extern ulong dynsoa_change_clock();
+        [DllImport(LIB)] public static extern UIntPtr dynsoa_change_block_rows(ulong view);
+        [DllImport(LIB)] public static extern void dynsoa_mark_changed(ulong view, int column, UIntPtr rowBegin, UIntPtr rowEnd);
+        [DllImport(LIB)] public static extern ulong dynsoa_column_version(ulong view, int column);
+        [DllImport(LIB)] public static extern UIntPtr dynsoa_changed_blocks(ulong view, int[] cols, int k, ulong since, [Out] uint[] outBlocks, UIntPtr maxOut);
+        [DllImport(LIB)] public static extern ulong dynsoa_entity_at(ulong view, UIntPtr row);
+        [DllImport(LIB)] public static extern UIntPtr dynsoa_entity_row(ulong view, ulong entity);
+        [DllImport(LIB)] public static extern int dynsoa_destroy_entity(ulong view, ulong entity);
+        [DllImport(LIB)] public static extern UIntPtr dynsoa_destroy_entities(ulong view, ulong[] entities, UIntPtr n);
+        [DllImport(LIB)] public static extern void dynsoa_cmd_spawn(ulong arch, UIntPtr count, IntPtr init_fn);
+        [DllImport(LIB)] public static extern void dynsoa_cmd_destroy(ulong view, ulong entity);
+        [DllImport(LIB, CharSet=CharSet.Ansi)] public static extern UIntPtr dynsoa_add_component(ulong view, ulong[] entities, UIntPtr n, string component, [Out] ulong[] outEntities);
+        [DllImport(LIB, CharSet=CharSet.Ansi)] public static extern UIntPtr dynsoa_remove_component(ulong view, ulong[] entities, UIntPtr n, string component, [Out] ulong[] outEntities);
+        [DllImport(LIB, CharSet=CharSet.Ansi)] public static extern void dynsoa_cmd_add_component(ulong view, ulong entity, string component);
+        [DllImport(LIB, CharSet=CharSet.Ansi)] public static extern void dynsoa_cmd_remove_component(ulong view, ulong entity, string component);
 
         [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
         public delegate void KernelFn(ulong view, ref KernelCtx ctx);
 
         [DllImport(LIB)] public static extern void dynsoa_begin_frame();
         [DllImport(LIB, CharSet=CharSet.Ansi)] public static extern void dynsoa_run_kernel(string name, KernelFn fn, ulong view, ref KernelCtx ctx);
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        public delegate void RangeKernelFn(ulong view, ref KernelCtx ctx, UIntPtr rowBegin, UIntPtr rowEnd);
+        [DllImport(LIB, CharSet=CharSet.Ansi)] public static extern void dynsoa_run_kernel_parallel(string name, RangeKernelFn fn, ulong view, ref KernelCtx ctx);
+        [DllImport(LIB, CharSet=CharSet.Ansi)] public static extern void dynsoa_run_kernel_query(string name, RangeKernelFn fn, ulong query, ref KernelCtx ctx);
+        [DllImport(LIB, CharSet=CharSet.Ansi)] public static extern void dynsoa_run_kernel_changed(string name, RangeKernelFn fn, ulong view, int[] cols, int k, ulong since, ref KernelCtx ctx);
         [DllImport(LIB)] public static extern void dynsoa_end_frame();
 
+        [DllImport(LIB, CharSet=CharSet.Ansi)] public static extern ulong dynsoa_make_query(string[] comps, int count);
+        [DllImport(LIB)] public static extern int dynsoa_query_views(ulong query, [Out] ulong[] outViews, int maxOut);
+
         [DllImport(LIB)] public static extern int dynsoa_retile_aosoa_plan_apply(ulong view, int tile);
         [DllImport(LIB)] public static extern int dynsoa_retile_to_soa(ulong view);
+        [DllImport(LIB)] public static extern int dynsoa_retile_sort_morton(ulong view);
+        [DllImport(LIB, CharSet=CharSet.Ansi)] public static extern int dynsoa_partition_by_mask(ulong view, string path, uint mask);
+        [DllImport(LIB)] public static extern int dynsoa_view_partitions(ulong view, [Out] RowPartition[] outGroups, int maxOut);
+        [DllImport(LIB)] public static extern UIntPtr dynsoa_set_chunked(ulong view, UIntPtr chunkBytes);
 
         [DllImport(LIB)] public static extern IntPtr dynsoa_acquire_matrix_block(ulong view, string[] comps, int k, int rows, UIntPtr offset, out MatrixBlock outBlock);
+        [DllImport(LIB)] public static extern IntPtr dynsoa_acquire_matrix_block_ex(ulong view, string[] comps, int k, int rows, UIntPtr offset, uint flags, out MatrixBlock outBlock);
         [DllImport(LIB)] public static extern void dynsoa_release_matrix_block(ulong view, ref MatrixBlock block, int write_back);
 
+        [DllImport(LIB)] public static extern IntPtr dynsoa_grid_create();
+        [DllImport(LIB)] public static extern void dynsoa_grid_destroy(IntPtr grid);
+        [DllImport(LIB)] public static extern void dynsoa_grid_build(IntPtr grid, ulong view, int x, int y, int z, float cellSize);
+        [DllImport(LIB)] public static extern int dynsoa_grid_query(IntPtr grid, float x, float y, float z, float radius, [Out] GridRange[] outRanges, int maxOut);
+        [DllImport(LIB)] public static extern IntPtr dynsoa_grid_order(IntPtr grid);
+
         [DllImport(LIB, CharSet=CharSet.Ansi)] public static extern void dynsoa_set_policy(string jsonOrEmpty);
 
         [DllImport(LIB, CharSet=CharSet.Ansi)] public static extern void dynsoa_metrics_enable_csv(string path);
@@ -87,6 +140,11 @@ namespace DynSoA
 
         public static void Spawn(ulong arch, ulong count)
             => Native.dynsoa_spawn(arch, (UIntPtr)count, IntPtr.Zero);
+        // Keep the delegate alive for the call; it may run on pool threads.
+        public static int SpawnBulk(ulong arch, ulong count, Native.SpawnInitFn init)
+            => (int)Native.dynsoa_spawn_bulk(arch, (UIntPtr)count, init, IntPtr.Zero);
+        public static unsafe Span<float> ColF32(in ColumnSet cols, int column)
+            => new Span<float>(((void**)cols.columns)[column], (int)cols.count);
 
         public static ulong MakeView(ulong arch) => Native.dynsoa_make_view(arch);
         public static int ViewLen(ulong view) => (int)Native.dynsoa_view_len(view);
@@ -96,14 +154,82 @@ namespace DynSoA
             return new Span<float>((void*)ptr, len);
         }
 
+        public static int ColumnId(ulong view, string path) => Native.dynsoa_column_id(view, path);
+        public static int TileRows(ulong view) => (int)Native.dynsoa_view_tile_rows(view);
+        public static int Capacity(ulong view) => (int)Native.dynsoa_view_capacity(view);
+        public static int PaddedLen(ulong view) => (int)Native.dynsoa_view_padded_len(view);
+        // Returns the back (write) column; EndFrame swaps it with the front.
+        public static int SetDoubleBuffered(ulong view, int column) => Native.dynsoa_set_double_buffered(view, column);
+        public static int ColumnNext(ulong view, int column) => Native.dynsoa_column_next(view, column);
+        public static int NumaNodeCount() => Native.dynsoa_numa_node_count();
+        public static int RowNode(ulong view, int row) => Native.dynsoa_view_row_node(view, (UIntPtr)row);
+        public static ulong ChangeClock() => Native.dynsoa_change_clock();
+        public static void MarkChanged(ulong view, int column, int rowBegin, int rowEnd)
+            => Native.dynsoa_mark_changed(view, column, (UIntPtr)rowBegin, (UIntPtr)rowEnd);
+        public static ulong ColumnVersion(ulong view, int column) => Native.dynsoa_column_version(view, column);
+        public static uint[] ChangedBlocks(ulong view, int[] columns, ulong since) {
+            int n = (int)Native.dynsoa_changed_blocks(view, columns, columns.Length, since, null, UIntPtr.Zero);
+            var blocks = new uint[n];
+            Native.dynsoa_changed_blocks(view, columns, columns.Length, since, blocks, (UIntPtr)n);
+            return blocks;
+        }
+        public static unsafe Span<float> ColTileF32(ulong view, int column, int tile, int len) {
+            IntPtr ptr = Native.dynsoa_column_tile(view, column, (UIntPtr)tile);
+            return new Span<float>((void*)ptr, len);
+        }
+        public static ulong EntityAt(ulong view, int row) => Native.dynsoa_entity_at(view, (UIntPtr)row);
+        public static long EntityRow(ulong view, ulong entity) => (long)(ulong)Native.dynsoa_entity_row(view, entity);
+        public static bool Destroy(ulong view, ulong entity) => Native.dynsoa_destroy_entity(view, entity) != 0;
+        public static int DestroyBatch(ulong view, ulong[] entities)
+            => (int)Native.dynsoa_destroy_entities(view, entities, (UIntPtr)entities.Length);
+        public static void DeferSpawn(ulong arch, ulong count) => Native.dynsoa_cmd_spawn(arch, (UIntPtr)count, IntPtr.Zero);
+        public static void DeferDestroy(ulong view, ulong entity) => Native.dynsoa_cmd_destroy(view, entity);
+        public static ulong[] AddComponent(ulong view, ulong[] entities, string component) {
+            var moved = new ulong[entities.Length];
+            Native.dynsoa_add_component(view, entities, (UIntPtr)entities.Length, component, moved);
+            return moved;
+        }
+        public static ulong[] RemoveComponent(ulong view, ulong[] entities, string component) {
+            var moved = new ulong[entities.Length];
+            Native.dynsoa_remove_component(view, entities, (UIntPtr)entities.Length, component, moved);
+            return moved;
+        }
+        public static void DeferAddComponent(ulong view, ulong entity, string component) => Native.dynsoa_cmd_add_component(view, entity, component);
+        public static void DeferRemoveComponent(ulong view, ulong entity, string component) => Native.dynsoa_cmd_remove_component(view, entity, component);
+        public static unsafe Span<float> ColF32(ulong view, int column, int len) {
+            IntPtr ptr = Native.dynsoa_column_ptr(view, column);
+            return new Span<float>((void*)ptr, len);
+        }
+
         public static void BeginFrame() => Native.dynsoa_begin_frame();
         public static void EndFrame() => Native.dynsoa_end_frame();
 
         public static void RunKernel(string name, Native.KernelFn fn, ulong view, KernelCtx ctx)
             => Native.dynsoa_run_kernel(name, fn, view, ref ctx);
 
+        public static ulong MakeQuery(string[] components) => Native.dynsoa_make_query(components, components.Length);
+        public static ulong[] QueryViews(ulong query) {
+            int n = Native.dynsoa_query_views(query, null, 0);
+            var views = new ulong[n];
+            Native.dynsoa_query_views(query, views, n);
+            return views;
+        }
+        public static void RunQuery(string name, Native.RangeKernelFn fn, ulong query, KernelCtx ctx)
+            => Native.dynsoa_run_kernel_query(name, fn, query, ref ctx);
+        public static void RunChanged(string name, Native.RangeKernelFn fn, ulong view, int[] columns, ulong since, KernelCtx ctx)
+            => Native.dynsoa_run_kernel_changed(name, fn, view, columns, columns.Length, since, ref ctx);
+
         public static bool RetileAoSoA(ulong view, int tile) => Native.dynsoa_retile_aosoa_plan_apply(view, tile) != 0;
         public static bool RetileToSoA(ulong view) => Native.dynsoa_retile_to_soa(view) != 0;
+        public static bool SortMorton(ulong view) => Native.dynsoa_retile_sort_morton(view) != 0;
+        public static bool PartitionByMask(ulong view, string path, uint mask = 0) => Native.dynsoa_partition_by_mask(view, path, mask) != 0;
+        public static RowPartition[] Partitions(ulong view) {
+            int n = Native.dynsoa_view_partitions(view, null, 0);
+            var groups = new RowPartition[n];
+            Native.dynsoa_view_partitions(view, groups, n);
+            return groups;
+        }
+        public static int SetChunked(ulong view, int chunkBytes = 16384) => (int)Native.dynsoa_set_chunked(view, (UIntPtr)chunkBytes);
 
         public static MatrixBlock AcquireMatrixBlock(ulong view, string[] comps, int rows, ulong offset = 0) {
             Native.dynsoa_acquire_matrix_block(view, comps, comps.Length, rows, (UIntPtr)offset, out MatrixBlock mb);
@@ -112,6 +238,15 @@ namespace DynSoA
         public static void ReleaseMatrixBlock(ulong view, ref MatrixBlock mb, bool writeBack=false)
             => Native.dynsoa_release_matrix_block(view, ref mb, writeBack?1:0);
 
+        public static IntPtr CreateGrid() => Native.dynsoa_grid_create();
+        public static void DestroyGrid(IntPtr grid) => Native.dynsoa_grid_destroy(grid);
+        public static void BuildGrid(IntPtr grid, ulong view, int x, int y, int z, float cellSize)
+            => Native.dynsoa_grid_build(grid, view, x, y, z, cellSize);
+        public static int QueryGrid(IntPtr grid, float x, float y, float z, float radius, GridRange[] ranges)
+            => Native.dynsoa_grid_query(grid, x, y, z, radius, ranges, ranges.Length);
+        public static unsafe ReadOnlySpan<uint> GridOrder(IntPtr grid, int len)
+            => new ReadOnlySpan<uint>((void*)Native.dynsoa_grid_order(grid), len);
+
         public static void SetPolicy(string jsonOrEmpty) => Native.dynsoa_set_policy(jsonOrEmpty);
         public static void EnableCSV(string path) => Native.dynsoa_metrics_enable_csv(path);
         public static void EmitMetric(Native.Sample s) => Native.dynsoa_emit_metric(ref s);
@@ -10,7 +10,7 @@ public class DynSoASmoke : MonoBehaviour
 
     void Start()
     {
-        var cfg = new Config { device = Device.CPU, aosoa_tile = 128, matrix_block = 1024, max_retile_us = 500, scheduler_enabled = true };
+        var cfg = new Config { device = Device.CPU, aosoa_tile = 128, matrix_block = 1024, max_retile_us = 500, scheduler_enabled = true, column_align = 64 };
         DynSoA.DynSoA.Init(cfg);
 
         DynSoA.DynSoA.DefineComponent("Position", new (string, ScalarType)[]{
@@ -29,9 +29,16 @@ public class DynSoASmoke : MonoBehaviour
     static void PhysicsStep(ulong v, ref KernelCtx ctx)
     {
         int n = DynSoA.DynSoA.ViewLen(v);
-        var px = DynSoA.DynSoA.ColF32(v, "Position.x", n);
-        var vx = DynSoA.DynSoA.ColF32(v, "Velocity.vx", n);
-        for (int i = 0; i < n; ++i) px[i] += vx[i] * ctx.dt;
+        int T = DynSoA.DynSoA.TileRows(v);
+        int cpx = DynSoA.DynSoA.ColumnId(v, "Position.x");
+        int cvx = DynSoA.DynSoA.ColumnId(v, "Velocity.vx");
+        // Walk tiles so the kernel stays valid after an AoSoA retile.
+        for (int b = 0, k = 0; b < n; b += T, ++k) {
+            int m = Mathf.Min(T, n - b);
+            var px = DynSoA.DynSoA.ColTileF32(v, cpx, k, m);
+            var vx = DynSoA.DynSoA.ColTileF32(v, cvx, k, m);
+            for (int i = 0; i < m; ++i) px[i] += vx[i] * ctx.dt;
+        }
     }
 
     void Update()